@@ -0,0 +1,276 @@
+// Checks ScheduleFetcher's retry behaviour against a mock HTTP server on the loopback interface. The server answers
+// each request with the next scripted response (5xx errors, Retry-After, a response slower than the request timeout
+// or a 200), records when each request arrived, and the checks compare those arrival times against the backoff
+// bounds. Exits with 1 if any check fails. Uses POSIX sockets, so it doesn't build on Windows.
+
+#include <SDL3/SDL_log.h>
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "ScheduleFetcher.h"
+
+using namespace std::chrono_literals;
+
+// short delays so the whole run takes a few seconds
+static constexpr ScheduleFetcher_Options HARNESS_OPTIONS = {
+        .baseDelay = 100ms, .maxDelay = 400ms, .requestTimeout = 300ms};
+// thread wakeups and loopback round trips, added to every upper bound
+static constexpr auto HARNESS_SLACK = 300ms;
+// timer granularity, taken off every lower bound
+static constexpr auto HARNESS_EARLY = 5ms;
+
+struct MockServer_Response {
+    int status = 503;
+    // sent as Retry-After in seconds when positive
+    int retryAfter = 0;
+    // how long to wait before answering
+    std::chrono::milliseconds delay{0};
+    std::string body;
+};
+
+// Answers every connection on its own thread with the next scripted response, or a plain 503 once the script has
+// run out.
+class MockServer {
+    int listenSocket = -1;
+    int port = 0;
+    std::mutex mutex;
+    std::deque<MockServer_Response> script;
+    std::vector<std::chrono::steady_clock::time_point> arrivals;
+    std::vector<std::thread> connections;
+    std::thread acceptor;
+    void Accept();
+    static void Answer(int connection, const MockServer_Response &response);
+public:
+    MockServer();
+    ~MockServer();
+    MockServer(const MockServer &) = delete;
+    MockServer &operator=(const MockServer &) = delete;
+    [[nodiscard]] bool IsListening() const { return this->listenSocket >= 0; }
+    [[nodiscard]] std::string GetUrl() const { return "http://127.0.0.1:" + std::to_string(this->port) + "/today"; }
+    void Script(std::deque<MockServer_Response> responses);
+    [[nodiscard]] std::vector<std::chrono::steady_clock::time_point> GetArrivals();
+};
+
+MockServer::MockServer() {
+    listenSocket = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    socklen_t addressSize = sizeof(address);
+    if (listenSocket < 0 || bind(listenSocket, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 ||
+        listen(listenSocket, 16) != 0 ||
+        getsockname(listenSocket, reinterpret_cast<sockaddr *>(&address), &addressSize) != 0) {
+        SDL_Log("Couldn't start the mock server");
+        if (listenSocket >= 0) {
+            close(listenSocket);
+        }
+        listenSocket = -1;
+        return;
+    }
+    port = ntohs(address.sin_port);
+    acceptor = std::thread(&MockServer::Accept, this);
+}
+
+MockServer::~MockServer() {
+    if (listenSocket >= 0) {
+        // wakes the blocked accept
+        shutdown(listenSocket, SHUT_RDWR);
+        close(listenSocket);
+    }
+    if (acceptor.joinable()) {
+        acceptor.join();
+    }
+    for (std::thread &connection: connections) {
+        connection.join();
+    }
+}
+
+void MockServer::Script(std::deque<MockServer_Response> responses) {
+    std::lock_guard lock(mutex);
+    script = std::move(responses);
+    arrivals.clear();
+}
+
+std::vector<std::chrono::steady_clock::time_point> MockServer::GetArrivals() {
+    std::lock_guard lock(mutex);
+    return arrivals;
+}
+
+void MockServer::Accept() {
+    while (true) {
+        const int connection = accept(listenSocket, nullptr, nullptr);
+        if (connection < 0) {
+            return;
+        }
+        std::lock_guard lock(mutex);
+        arrivals.push_back(std::chrono::steady_clock::now());
+        MockServer_Response response;
+        if (!script.empty()) {
+            response = std::move(script.front());
+            script.pop_front();
+        }
+        connections.emplace_back(&MockServer::Answer, connection, std::move(response));
+    }
+}
+
+void MockServer::Answer(const int connection, const MockServer_Response &response) {
+    // the request itself doesn't matter, only that it was read before answering
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos) {
+        const ssize_t received = recv(connection, buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            close(connection);
+            return;
+        }
+        request.append(buffer, received);
+    }
+    std::this_thread::sleep_for(response.delay);
+    std::string text = "HTTP/1.1 " + std::to_string(response.status) + (response.status == 200 ? " OK" : " Error") +
+                       "\r\nContent-Length: " + std::to_string(response.body.size()) + "\r\nConnection: close\r\n";
+    if (response.retryAfter > 0) {
+        text += "Retry-After: " + std::to_string(response.retryAfter) + "\r\n";
+    }
+    text += "\r\n" + response.body;
+    // the client may have timed out and gone already, SIGPIPE is ignored so that only fails this send
+    send(connection, text.data(), text.size(), 0);
+    close(connection);
+}
+
+static int failures = 0;
+
+static void Expect(const bool condition, const char *check) {
+    std::printf("%s %s\n", condition ? "PASS" : "FAIL", check);
+    if (!condition) {
+        failures++;
+    }
+}
+
+static bool WaitUntil(const std::function<bool()> &condition, const std::chrono::milliseconds timeout) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(5ms);
+    }
+    return true;
+}
+
+static std::chrono::milliseconds Gap(const std::vector<std::chrono::steady_clock::time_point> &arrivals,
+                                     const size_t index) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(arrivals[index] - arrivals[index - 1]);
+}
+
+// Counts what the fetcher hands to its response handler. Only a body of "ok" is accepted.
+struct Harness_Handler {
+    std::atomic<int> accepted = 0;
+    std::atomic<int> rejected = 0;
+    ScheduleFetcher::ResponseHandler Get() {
+        return [this](const std::string &body) {
+            (body == "ok" ? accepted : rejected)++;
+            return body == "ok";
+        };
+    }
+};
+
+// 5xx errors and a rejected body are retried, each wait within the equal jitter bounds of its attempt
+static void CheckBackoff(MockServer &server) {
+    server.Script({{.status = 503}, {.status = 500}, {.status = 200, .body = "bad"}, {.status = 502},
+                   {.status = 503}, {.status = 200, .body = "ok"}});
+    Harness_Handler handler;
+    ScheduleFetcher fetcher(server.GetUrl(), handler.Get(), HARNESS_OPTIONS);
+    fetcher.Fetch();
+    Expect(WaitUntil([&] { return !fetcher.IsFetching(); }, 10s), "backoff: fetch finishes");
+    const auto arrivals = server.GetArrivals();
+    Expect(arrivals.size() == 6, "backoff: one request per scripted response");
+    Expect(handler.accepted == 1 && handler.rejected == 1, "backoff: handler sees the bad and the good body");
+    for (size_t attempt = 0; attempt + 1 < arrivals.size(); ++attempt) {
+        const auto cap = std::min(HARNESS_OPTIONS.maxDelay, HARNESS_OPTIONS.baseDelay * (1 << attempt));
+        const auto gap = Gap(arrivals, attempt + 1);
+        std::printf("     attempt %zu waited %lld ms, allowed %lld-%lld ms\n", attempt + 1,
+                    static_cast<long long>(gap.count()), static_cast<long long>((cap / 2).count()),
+                    static_cast<long long>(cap.count()));
+        Expect(gap >= cap / 2 - HARNESS_EARLY && gap <= cap + HARNESS_SLACK, "backoff: wait within bounds");
+    }
+}
+
+// a Retry-After longer than the backoff replaces it
+static void CheckRetryAfter(MockServer &server) {
+    server.Script({{.status = 503, .retryAfter = 1}, {.status = 200, .body = "ok"}});
+    Harness_Handler handler;
+    ScheduleFetcher fetcher(server.GetUrl(), handler.Get(), HARNESS_OPTIONS);
+    fetcher.Fetch();
+    Expect(WaitUntil([&] { return !fetcher.IsFetching(); }, 10s), "retry-after: fetch finishes");
+    const auto arrivals = server.GetArrivals();
+    Expect(arrivals.size() == 2 && handler.accepted == 1, "retry-after: retried once");
+    if (arrivals.size() >= 2) {
+        const auto gap = Gap(arrivals, 1);
+        std::printf("     waited %lld ms\n", static_cast<long long>(gap.count()));
+        Expect(gap >= 1000ms - HARNESS_EARLY && gap <= 1000ms + HARNESS_SLACK, "retry-after: waited one second");
+    }
+}
+
+// a response slower than the request timeout is given up on and retried
+static void CheckTimeout(MockServer &server) {
+    server.Script({{.status = 200, .delay = 1500ms, .body = "ok"}, {.status = 200, .body = "ok"}});
+    Harness_Handler handler;
+    ScheduleFetcher fetcher(server.GetUrl(), handler.Get(), HARNESS_OPTIONS);
+    fetcher.Fetch();
+    Expect(WaitUntil([&] { return !fetcher.IsFetching(); }, 10s), "timeout: fetch finishes");
+    const auto arrivals = server.GetArrivals();
+    Expect(arrivals.size() == 2 && handler.accepted == 1, "timeout: retried once");
+    if (arrivals.size() >= 2) {
+        const auto gap = Gap(arrivals, 1);
+        const auto lowest = HARNESS_OPTIONS.requestTimeout + HARNESS_OPTIONS.baseDelay / 2;
+        std::printf("     retried after %lld ms\n", static_cast<long long>(gap.count()));
+        Expect(gap >= lowest - HARNESS_EARLY && gap < 1500ms, "timeout: retried before the slow response finished");
+    }
+}
+
+// cancelling while the server keeps failing stops the retries right away
+static void CheckCancel(MockServer &server) {
+    server.Script({});
+    Harness_Handler handler;
+    ScheduleFetcher fetcher(server.GetUrl(), handler.Get(), HARNESS_OPTIONS);
+    fetcher.Fetch();
+    Expect(WaitUntil([&] { return server.GetArrivals().size() >= 2; }, 10s), "cancel: failing fetch is retried");
+    const auto cancelStart = std::chrono::steady_clock::now();
+    fetcher.Cancel();
+    const auto cancelTime = std::chrono::steady_clock::now() - cancelStart;
+    const size_t requests = server.GetArrivals().size();
+    std::this_thread::sleep_for(2 * HARNESS_OPTIONS.maxDelay);
+    fetcher.Fetch();
+    std::this_thread::sleep_for(HARNESS_OPTIONS.maxDelay);
+    Expect(cancelTime < HARNESS_OPTIONS.requestTimeout + HARNESS_SLACK,
+           "cancel: returns without waiting out the backoff");
+    Expect(server.GetArrivals().size() == requests, "cancel: no requests after cancelling");
+    Expect(handler.accepted == 0 && handler.rejected == 0, "cancel: handler never called");
+}
+
+int main() {
+    std::signal(SIGPIPE, SIG_IGN);
+    MockServer server;
+    if (!server.IsListening()) {
+        return 1;
+    }
+    CheckBackoff(server);
+    CheckRetryAfter(server);
+    CheckTimeout(server);
+    CheckCancel(server);
+    std::printf("%d checks failed\n", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,248 @@
+// Headless benchmark for the overlay render path. Drives Overlay::Render with a fixed schedule and a simulated
+// clock on SDL's offscreen video driver and a software renderer, then reports frame times, heap allocations
+// per frame and how often TextManager had to rasterize text or create textures.
+//
+// --check instead steps the same clock through the first period of bench/schedule.json and compares the event
+// text, countdown, color and progress the overlay drew at each warning threshold. It exits with 1 on a mismatch.
+
+#include <SDL3/SDL.h>
+#include <SDL3_ttf/SDL_ttf.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "AllocationCounter.h"
+#include "FontCache.h"
+#include "Overlay.h"
+#include "Schedule.h"
+#include "ScheduleParser.h"
+#include "Settings.h"
+#include "TextManager.h"
+
+#ifndef BENCH_SCHEDULE_JSON
+#define BENCH_SCHEDULE_JSON "./bench/schedule.json"
+#endif
+#define BENCH_SETTINGS_FILE_PATH "./bench_settings.json"
+#define BENCH_WINDOW_WIDTH 250
+#define BENCH_WINDOW_HEIGHT 47
+
+static int ParseTimeOfDay(const char *value) {
+    int hours = 0;
+    int minutes = 0;
+    if (std::sscanf(value, "%d:%d", &hours, &minutes) != 2) {
+        return -1;
+    }
+    return hours * 60 * 60 + minutes * 60;
+}
+
+struct Bench_Checkpoint {
+    const char *time;
+    std::string_view event;
+    std::string_view countdown;
+    SDL_Color color;
+    float progress;
+};
+
+static constexpr SDL_Color BENCH_WHITE = {255, 255, 255, 255};
+static constexpr SDL_Color BENCH_ORANGE = {237, 153, 64, 255};
+static constexpr SDL_Color BENCH_RED = {255, 100, 100, 255};
+
+// Period 1 runs 7:20 to 8:10 on both tracks of bench/schedule.json, Period 2 starts at 8:15
+static constexpr Bench_Checkpoint BENCH_CHECKPOINTS[] = {
+        {"07:20:00", "Period 1", "50:00", BENCH_WHITE, 0.0f},
+        {"07:59:59", "Period 1", "10:01", BENCH_WHITE, 2399.0f / 3000.0f},
+        {"08:00:00", "Period 1", "10:00", BENCH_ORANGE, 0.8f},
+        {"08:06:59", "Period 1", "03:01", BENCH_ORANGE, 2819.0f / 3000.0f},
+        {"08:07:00", "Period 1", "03:00", BENCH_RED, 0.94f},
+        {"08:08:59", "Period 1", "01:01", BENCH_RED, 2939.0f / 3000.0f},
+        // the last minute flashes between red on even and white on odd seconds
+        {"08:09:00", "Period 1", "01:00", BENCH_RED, 0.98f},
+        {"08:09:01", "Period 1", "00:59", BENCH_WHITE, 2941.0f / 3000.0f},
+        {"08:09:59", "Period 1", "00:01", BENCH_WHITE, 2999.0f / 3000.0f},
+        {"08:10:00", "Go to Period 2", "05:00", BENCH_ORANGE, 0.0f},
+        {"08:14:59", "Go to Period 2", "00:01", BENCH_WHITE, 299.0f / 300.0f},
+        {"08:15:00", "Period 2", "50:00", BENCH_WHITE, 0.0f},
+};
+
+static int ParseCheckpointTime(const char *value) {
+    int hours = 0;
+    int minutes = 0;
+    int seconds = 0;
+    if (std::sscanf(value, "%d:%d:%d", &hours, &minutes, &seconds) != 3) {
+        return -1;
+    }
+    return hours * 60 * 60 + minutes * 60 + seconds;
+}
+
+static bool SameColor(const SDL_Color a, const SDL_Color b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+
+// Renders every checkpoint in order, like a clock that jumps ahead between them, and reports each mismatch.
+static int RunChecks(Overlay &overlay, const Schedule &schedule, Settings &settings) {
+    // the checkpoints expect the defaults, not whatever an earlier run left in the settings file
+    settings.theme = DARK;
+    settings.showSeconds = true;
+    settings.showPercentage = false;
+    settings.largeText = false;
+    settings.currentLunch = 0;
+    for (auto &[name, alias]: settings.periodAliases) {
+        alias = name;
+    }
+    settings.RebuildEventNames();
+
+    int failures = 0;
+    for (const auto &[time, event, countdown, color, progress]: BENCH_CHECKPOINTS) {
+        const Overlay_Frame frame = overlay.Render(&schedule, ParseCheckpointTime(time), 1.0f, BENCH_WINDOW_WIDTH,
+                                                   BENCH_WINDOW_HEIGHT);
+        const bool passed = frame.hasSchedule && frame.event.View() == event && frame.countdown.View() == countdown &&
+                            SameColor(frame.textColor, color) && std::abs(frame.progress - progress) < 0.0001f;
+        if (!passed) {
+            std::printf("FAIL %s: got \"%.*s\" %.*s rgb(%d, %d, %d) %.4f, "
+                        "expected \"%.*s\" %.*s rgb(%d, %d, %d) %.4f\n",
+                        time, static_cast<int>(frame.event.View().size()), frame.event.View().data(),
+                        static_cast<int>(frame.countdown.View().size()), frame.countdown.View().data(),
+                        frame.textColor.r, frame.textColor.g, frame.textColor.b, frame.progress,
+                        static_cast<int>(event.size()), event.data(), static_cast<int>(countdown.size()),
+                        countdown.data(), color.r, color.g, color.b, progress);
+            failures++;
+        }
+    }
+    std::printf("checkpoints:         %d passed, %d failed\n",
+                static_cast<int>(std::size(BENCH_CHECKPOINTS)) - failures, failures);
+    return failures == 0 ? 0 : 1;
+}
+
+static double Percentile(const std::vector<Uint64> &sorted, const double percentile) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    const auto index = static_cast<size_t>(percentile * static_cast<double>(sorted.size() - 1));
+    return static_cast<double>(sorted[index]) / 1000.0;
+}
+
+// Renders frameCount frames stepSeconds apart and prints frame times, allocations and text cache statistics.
+static int RunBenchmark(Overlay &overlay, const Schedule &schedule, const TextManager &textManager,
+                        const int startSeconds, const int frameCount, const int stepSeconds) {
+    std::vector<Uint64> frameTimes;
+    std::vector<Uint64> frameAllocations;
+    frameTimes.reserve(frameCount);
+    frameAllocations.reserve(frameCount);
+
+    for (int frame = 0; frame < frameCount; ++frame) {
+        const int secondsOfDay = (startSeconds + frame * stepSeconds) % (24 * 60 * 60);
+        const Uint64 allocationsBefore = Alloc_GetCount();
+        const Uint64 startNS = SDL_GetTicksNS();
+        overlay.Render(&schedule, secondsOfDay, 1.0f, BENCH_WINDOW_WIDTH, BENCH_WINDOW_HEIGHT);
+        const Uint64 endNS = SDL_GetTicksNS();
+        frameAllocations.push_back(Alloc_GetCount() - allocationsBefore);
+        frameTimes.push_back(endNS - startNS);
+    }
+
+    const Uint64 totalAllocations = std::accumulate(frameAllocations.begin(), frameAllocations.end(), Uint64{0});
+    const auto allocatingFrames = std::ranges::count_if(frameAllocations, [](const Uint64 count) { return count > 0; });
+    const Uint64 maxAllocations = std::ranges::max(frameAllocations);
+    std::ranges::sort(frameTimes);
+    const TextManager_Stats &stats = textManager.GetStats();
+
+    std::printf("frames:              %d (step %d s)\n", frameCount, stepSeconds);
+    std::printf("frame time (us):     p50 %.1f  p90 %.1f  p99 %.1f  max %.1f\n", Percentile(frameTimes, 0.5),
+                Percentile(frameTimes, 0.9), Percentile(frameTimes, 0.99), Percentile(frameTimes, 1.0));
+    std::printf("heap allocations:    %.2f per frame, max %llu, %lld of %d frames allocated\n",
+                static_cast<double>(totalAllocations) / frameCount, static_cast<unsigned long long>(maxAllocations),
+                static_cast<long long>(allocatingFrames), frameCount);
+    std::printf("TTF_Render calls:    %llu\n", static_cast<unsigned long long>(stats.rasterizations));
+    std::printf("texture creations:   %llu\n", static_cast<unsigned long long>(stats.textureCreations));
+    std::printf("text cache:          %llu hits, %llu misses, %llu evictions, %zu textures, %zu bytes\n",
+                static_cast<unsigned long long>(stats.hits), static_cast<unsigned long long>(stats.misses),
+                static_cast<unsigned long long>(stats.evictions), stats.textureCount, stats.textureBytes);
+    std::printf("glyph atlases:       %zu, %zu bytes\n", stats.atlasCount, stats.atlasBytes);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    int startSeconds = 0;
+    int frameCount = 24 * 60 * 60;
+    int stepSeconds = 1;
+    std::string schedulePath = BENCH_SCHEDULE_JSON;
+    bool check = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--check") == 0) {
+            check = true;
+        } else if (i + 1 == argc) {
+            break;
+        } else if (std::strcmp(argv[i], "--start") == 0) {
+            startSeconds = ParseTimeOfDay(argv[++i]);
+        } else if (std::strcmp(argv[i], "--frames") == 0) {
+            frameCount = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--step") == 0) {
+            stepSeconds = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--schedule") == 0) {
+            schedulePath = argv[++i];
+        }
+    }
+    if (startSeconds < 0 || frameCount <= 0 || stepSeconds <= 0) {
+        SDL_Log("Usage: %s [--check] [--start HH:MM] [--frames N] [--step SECONDS] [--schedule FILE]", argv[0]);
+        return 1;
+    }
+
+    SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen");
+    if (!SDL_Init(SDL_INIT_VIDEO)) {
+        SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "dummy");
+        if (!SDL_Init(SDL_INIT_VIDEO)) {
+            SDL_Log("Couldn't initialize SDL: %s", SDL_GetError());
+            return 1;
+        }
+    }
+    if (!TTF_Init()) {
+        SDL_Log("Couldn't initialize SDL_ttf: %s", SDL_GetError());
+        return 1;
+    }
+
+    SDL_Surface *target = SDL_CreateSurface(BENCH_WINDOW_WIDTH, BENCH_WINDOW_HEIGHT, SDL_PIXELFORMAT_ARGB8888);
+    SDL_Renderer *renderer = target != nullptr ? SDL_CreateSoftwareRenderer(target) : nullptr;
+    if (renderer == nullptr) {
+        SDL_Log("Couldn't create software renderer: %s", SDL_GetError());
+        return 1;
+    }
+
+    auto *settings = new Settings(BENCH_SETTINGS_FILE_PATH);
+    auto *fontCache = new FontCache(settings->fontLocation);
+    if (fontCache->Acquire(32) == nullptr) {
+        return 1;
+    }
+    fontCache->Release(32);
+    settings->SetFontCache(fontCache);
+
+    std::ifstream scheduleFile(schedulePath, std::ios::binary);
+    const std::string scheduleText{std::istreambuf_iterator<char>(scheduleFile), std::istreambuf_iterator<char>()};
+    Schedule_Response response;
+    if (Sched_ParseError error; !Sched_ParseResponse(scheduleText, response, error)) {
+        SDL_Log("Couldn't read schedule %s: %s", schedulePath.c_str(), error.message.c_str());
+        return 1;
+    }
+    const Schedule schedule(std::move(response.status), std::move(response.data), 0, settings);
+
+    auto *textManager = new TextManager(renderer);
+    Overlay overlay(renderer, textManager, settings, fontCache);
+
+    const int result = check ? RunChecks(overlay, schedule, *settings)
+                             : RunBenchmark(overlay, schedule, *textManager, startSeconds, frameCount, stepSeconds);
+
+    delete textManager;
+    delete fontCache;
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroySurface(target);
+    delete settings;
+    TTF_Quit();
+    SDL_Quit();
+    return result;
+}
@@ -0,0 +1,25 @@
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef CROOMS_COUNT_ALLOCATIONS
+static std::atomic<Uint64> allocationCount = 0;
+
+void *operator new(const std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *ptr = std::malloc(size != 0 ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+
+Uint64 Alloc_GetCount() { return allocationCount.load(std::memory_order_relaxed); }
+#else
+Uint64 Alloc_GetCount() { return 0; }
+#endif
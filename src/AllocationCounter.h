@@ -0,0 +1,12 @@
+#pragma once
+#include <SDL3/SDL_stdinc.h>
+
+// Counts every allocation made through the global operator new when the build defines CROOMS_COUNT_ALLOCATIONS,
+// so a debug build can show that a steady-state frame doesn't touch the heap. Without it the count stays 0.
+#ifdef CROOMS_COUNT_ALLOCATIONS
+static constexpr bool ALLOC_COUNTING = true;
+#else
+static constexpr bool ALLOC_COUNTING = false;
+#endif
+
+Uint64 Alloc_GetCount();
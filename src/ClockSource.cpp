@@ -0,0 +1,36 @@
+#include "ClockSource.h"
+
+#include <cmath>
+
+std::chrono::system_clock::time_point SystemClockSource::Now() const {
+    return std::chrono::system_clock::now();
+}
+
+std::chrono::steady_clock::time_point SystemClockSource::SteadyNow() const {
+    return std::chrono::steady_clock::now();
+}
+
+std::chrono::nanoseconds SystemClockSource::ToRealDuration(const std::chrono::nanoseconds duration) const {
+    return duration;
+}
+
+SimulatedClockSource::SimulatedClockSource(const std::chrono::system_clock::time_point start, const double speed) :
+    start(start), realStart(std::chrono::steady_clock::now()), speed(speed > 0 ? speed : 1.0) {}
+
+std::chrono::nanoseconds SimulatedClockSource::Elapsed() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - realStart) * speed);
+}
+
+std::chrono::system_clock::time_point SimulatedClockSource::Now() const {
+    return start + std::chrono::duration_cast<std::chrono::system_clock::duration>(Elapsed());
+}
+
+std::chrono::steady_clock::time_point SimulatedClockSource::SteadyNow() const {
+    return realStart + std::chrono::duration_cast<std::chrono::steady_clock::duration>(Elapsed());
+}
+
+std::chrono::nanoseconds SimulatedClockSource::ToRealDuration(const std::chrono::nanoseconds duration) const {
+    // round up so a wakeup never lands just before the moment it was meant for
+    return std::chrono::nanoseconds(static_cast<long long>(std::ceil(static_cast<double>(duration.count()) / speed)));
+}
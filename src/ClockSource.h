@@ -0,0 +1,33 @@
+#pragma once
+#include <chrono>
+
+// Where the overlay gets the current time from. Everything that reads the time or waits for it to pass goes
+// through one of these, so a whole day can be replayed faster than real time.
+class ClockSource {
+public:
+    virtual ~ClockSource() = default;
+    [[nodiscard]] virtual std::chrono::system_clock::time_point Now() const = 0;
+    [[nodiscard]] virtual std::chrono::steady_clock::time_point SteadyNow() const = 0;
+    // how long to actually wait for this much of the clock's time to pass
+    [[nodiscard]] virtual std::chrono::nanoseconds ToRealDuration(std::chrono::nanoseconds duration) const = 0;
+};
+
+class SystemClockSource final : public ClockSource {
+public:
+    [[nodiscard]] std::chrono::system_clock::time_point Now() const override;
+    [[nodiscard]] std::chrono::steady_clock::time_point SteadyNow() const override;
+    [[nodiscard]] std::chrono::nanoseconds ToRealDuration(std::chrono::nanoseconds duration) const override;
+};
+
+// Starts at a given moment and runs speed times faster than real time.
+class SimulatedClockSource final : public ClockSource {
+    std::chrono::system_clock::time_point start;
+    std::chrono::steady_clock::time_point realStart;
+    double speed;
+    [[nodiscard]] std::chrono::nanoseconds Elapsed() const;
+public:
+    SimulatedClockSource(std::chrono::system_clock::time_point start, double speed);
+    [[nodiscard]] std::chrono::system_clock::time_point Now() const override;
+    [[nodiscard]] std::chrono::steady_clock::time_point SteadyNow() const override;
+    [[nodiscard]] std::chrono::nanoseconds ToRealDuration(std::chrono::nanoseconds duration) const override;
+};
@@ -0,0 +1,44 @@
+#include "EventNameTable.h"
+
+#include <charconv>
+#include <utility>
+
+// the codes the API is known to send, with the names the aliases are keyed by
+static constexpr std::pair<int, std::string_view> KNOWN_EVENTS[] = {
+        {0, "Nothing"},    {1, "Period 1"},       {2, "Period 2"},   {3, "Period 3"},     {4, "Period 4"},
+        {5, "Period 5"},   {6, "Period 6"},       {7, "Period 7"},   {100, "Morning"},    {101, "Welcome"},
+        {102, "Lunch"},    {103, "Homeroom"},     {104, "Dismissal"}, {105, "After School"}, {106, "End"},
+        {107, "Break"},    {110, "PSAT/SAT"},
+};
+static constexpr std::string_view UNKNOWN_EVENT_PREFIX = "Event ";
+
+void EventNameTable::Rebuild(const std::pmr::map<std::string, std::string, std::less<>> &aliases) {
+    names.clear();
+    sparseNames.clear();
+    const auto set = [this](const int event, const std::string_view name) {
+        if (event > MAX_DENSE_EVENT) {
+            sparseNames.insert_or_assign(event, std::string(name));
+            return;
+        }
+        if (static_cast<size_t>(event) >= names.size()) {
+            names.resize(event + 1);
+        }
+        names[event].emplace(name);
+    };
+    for (const auto &[event, name]: KNOWN_EVENTS) {
+        const auto alias = aliases.find(name);
+        set(event, alias != aliases.end() ? std::string_view(alias->second) : name);
+    }
+    // codes that are new to us can still be named with an "Event N" alias
+    for (const auto &[name, alias]: aliases) {
+        if (!name.starts_with(UNKNOWN_EVENT_PREFIX)) {
+            continue;
+        }
+        const char *first = name.data() + UNKNOWN_EVENT_PREFIX.size();
+        const char *last = name.data() + name.size();
+        if (int event = 0; std::from_chars(first, last, event).ptr == last && event >= 0 &&
+                           event <= MAX_EVENT_CODE) {
+            set(event, alias);
+        }
+    }
+}
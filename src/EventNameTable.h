@@ -0,0 +1,35 @@
+#pragma once
+#include <functional>
+#include <map>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Largest event code a schedule can contain. The parser rejects anything above it, and every code up to it can be
+// named with an "Event N" alias. Schedule history stores codes in 16 bits.
+static constexpr int MAX_EVENT_CODE = 0xFFFF;
+// codes up to this one are kept in the dense array, the few aliased codes above it in a map
+static constexpr int MAX_DENSE_EVENT = 1023;
+
+// Display names of the API's event codes with the user's aliases applied, indexed by event code so a lookup is a
+// bounds check and an array read. Settings rebuilds it whenever an alias changes, on the main thread.
+class EventNameTable {
+    std::vector<std::optional<std::string>> names;
+    std::map<int, std::string> sparseNames;
+public:
+    void Rebuild(const std::pmr::map<std::string, std::string, std::less<>>& aliases);
+    // nullptr for codes the table doesn't know, callers show those as "Event N". The name is only valid until the
+    // next Rebuild, so use it right away instead of keeping the pointer.
+    [[nodiscard]] const std::string* Get(const int event) const {
+        if (event > MAX_DENSE_EVENT) {
+            const auto name = sparseNames.find(event);
+            return name != sparseNames.end() ? &name->second : nullptr;
+        }
+        if (event < 0 || static_cast<size_t>(event) >= names.size() || !names[event]) {
+            return nullptr;
+        }
+        return &*names[event];
+    }
+};
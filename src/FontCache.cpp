@@ -0,0 +1,72 @@
+#include "FontCache.h"
+
+#include <SDL3/SDL_log.h>
+#include <algorithm>
+#include <cmath>
+#include <ranges>
+
+FontCache::~FontCache() {
+    // the TextManagers may already be gone, so onClose isn't called here
+    for (FontCache_Entry &entry: fonts | std::views::values) {
+        if (entry.font != nullptr) {
+            TTF_CloseFont(entry.font);
+        }
+    }
+}
+
+int FontCache::PixelSize(const float pixelSize) {
+    // sizes are rounded to whole pixels so tiny scale differences share one font
+    return std::max(1, static_cast<int>(std::lround(pixelSize)));
+}
+
+void FontCache::Close(FontCache_Entry &entry) {
+    if (entry.font != nullptr) {
+        onClose(entry.font);
+        TTF_CloseFont(entry.font);
+    }
+    entry.font = nullptr;
+    entry.opened = false;
+}
+
+TTF_Font *FontCache::Acquire(const float pixelSize) {
+    fonts[PixelSize(pixelSize)].users++;
+    return Get(pixelSize);
+}
+
+void FontCache::Release(const float pixelSize) {
+    const auto it = fonts.find(PixelSize(pixelSize));
+    if (it == fonts.end() || --it->second.users > 0) {
+        return;
+    }
+    // sizes of an old display scale don't linger once nothing draws with them
+    Close(it->second);
+    fonts.erase(it);
+}
+
+TTF_Font *FontCache::Get(const float pixelSize) {
+    const int size = PixelSize(pixelSize);
+    const auto it = fonts.find(size);
+    if (it == fonts.end()) {
+        return nullptr;
+    }
+    FontCache_Entry &entry = it->second;
+    if (!entry.opened) {
+        // failures are remembered too, so a missing font isn't retried every frame
+        entry.opened = true;
+        entry.font = TTF_OpenFont(path.c_str(), static_cast<float>(size));
+        if (entry.font == nullptr) {
+            SDL_Log("TTF_OpenFont() Error: %s", SDL_GetError());
+        }
+    }
+    return entry.font;
+}
+
+void FontCache::SetPath(const std::string &path) {
+    if (path == this->path) {
+        return;
+    }
+    for (FontCache_Entry &entry: fonts | std::views::values) {
+        Close(entry);
+    }
+    this->path = path;
+}
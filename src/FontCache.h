@@ -0,0 +1,38 @@
+#pragma once
+#include <SDL3_ttf/SDL_ttf.h>
+#include <functional>
+#include <map>
+#include <string>
+
+struct FontCache_Entry {
+    // nullptr until opened, or if opening failed
+    TTF_Font* font = nullptr;
+    bool opened = false;
+    int users = 0;
+};
+
+// Fonts opened at the exact pixel size they are drawn at, shared by every window and TextManager. Drawing text at
+// its native size instead of scaling down a large rasterization keeps small text sharp and saves the pixels.
+// Only one font file is in use at a time, so sizes are the key; SetPath switches every size to another file.
+class FontCache {
+    // the font file in use, edits to the setting only take effect once they are applied with SetPath
+    std::string path;
+    std::map<int, FontCache_Entry> fonts;
+    std::function<void(TTF_Font*)> onClose = [](TTF_Font*) {};
+    static int PixelSize(float pixelSize);
+    void Close(FontCache_Entry& entry);
+public:
+    explicit FontCache(std::string path) { this->path = std::move(path); }
+    ~FontCache();
+    FontCache(const FontCache&) = delete;
+    FontCache& operator=(const FontCache&) = delete;
+    // runs before any font is closed, so every TextManager can drop the textures and atlases made with it
+    void SetOnClose(std::function<void(TTF_Font*)> onClose) { this->onClose = std::move(onClose); }
+    // keeps the size open until every Acquire is matched by a Release, returns nullptr if it couldn't be opened
+    TTF_Font* Acquire(float pixelSize);
+    void Release(float pixelSize);
+    // the font of an acquired size, nullptr for sizes nobody acquired
+    TTF_Font* Get(float pixelSize);
+    // switches to another font file, the acquired sizes are reopened from it when they are next used
+    void SetPath(const std::string& path);
+};
@@ -0,0 +1,82 @@
+#include "FrameScheduler.h"
+
+#include <SDL3/SDL_timer.h>
+#include <chrono>
+
+// wake up slightly after a boundary so the clock has definitely rolled over when we redraw, SDL's ticks and the
+// steady clock the boundary is measured on don't have to be the same clock
+static constexpr Uint64 BOUNDARY_MARGIN_NS = SDL_NS_PER_MS * 2;
+
+FrameScheduler::FrameScheduler(SDL_Window *window, const ClockSource *clockSource) {
+    this->clockSource = clockSource;
+    this->wakeEventType = SDL_RegisterEvents(1);
+    const SDL_WindowFlags flags = SDL_GetWindowFlags(window);
+    this->visible = (flags & (SDL_WINDOW_HIDDEN | SDL_WINDOW_MINIMIZED | SDL_WINDOW_OCCLUDED)) == 0;
+}
+
+void FrameScheduler::ScheduleIn(const Uint64 delayNS) {
+    const Uint64 target = SDL_GetTicksNS() + delayNS;
+    if (this->deadlineNS == 0 || target < this->deadlineNS) {
+        this->deadlineNS = target;
+    }
+}
+
+void FrameScheduler::ScheduleNextVisibleChange(ScheduleClock &scheduleClock, const bool everySecond) {
+    // measured on the same steady anchor the frame's time of day came from, so the redraw lands after the second
+    // it shows has actually rolled over
+    const std::chrono::nanoseconds period = everySecond ? std::chrono::seconds(1) : std::chrono::minutes(1);
+    const auto untilBoundary = clockSource->ToRealDuration(scheduleClock.TimeUntilBoundary(period));
+    ScheduleIn(static_cast<Uint64>(untilBoundary.count()) + BOUNDARY_MARGIN_NS);
+}
+
+bool FrameScheduler::IsFrameDue() {
+    if (!this->dirty && (this->deadlineNS == 0 || SDL_GetTicksNS() < this->deadlineNS)) {
+        return false;
+    }
+    this->dirty = false;
+    this->deadlineNS = 0;
+    return true;
+}
+
+void FrameScheduler::WaitForNextFrame() const {
+    if (this->dirty) {
+        return;
+    }
+    Sint32 timeoutMS = -1;
+    if (this->deadlineNS != 0) {
+        const Uint64 now = SDL_GetTicksNS();
+        if (now >= this->deadlineNS) {
+            return;
+        }
+        timeoutMS = static_cast<Sint32>((this->deadlineNS - now + SDL_NS_PER_MS - 1) / SDL_NS_PER_MS);
+    }
+    // returns as soon as any event is queued, the event itself is delivered through SDL_AppEvent
+    SDL_WaitEventTimeout(nullptr, timeoutMS);
+}
+
+void FrameScheduler::RequestWakeup() const {
+    SDL_Event event = {};
+    event.type = this->wakeEventType;
+    SDL_PushEvent(&event);
+}
+
+bool FrameScheduler::IsWakeEvent(const SDL_Event *event) const {
+    return this->wakeEventType != 0 && event->type == this->wakeEventType;
+}
+
+void FrameScheduler::OnWindowEvent(const SDL_Event *event) {
+    switch (event->type) {
+        case SDL_EVENT_WINDOW_HIDDEN:
+        case SDL_EVENT_WINDOW_MINIMIZED:
+        case SDL_EVENT_WINDOW_OCCLUDED:
+            this->visible = false;
+            break;
+        case SDL_EVENT_WINDOW_SHOWN:
+        case SDL_EVENT_WINDOW_RESTORED:
+        case SDL_EVENT_WINDOW_EXPOSED:
+            this->visible = true;
+            break;
+        default:;
+    }
+    Invalidate();
+}
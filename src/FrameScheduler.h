@@ -0,0 +1,28 @@
+#pragma once
+#include <SDL3/SDL_events.h>
+#include <SDL3/SDL_video.h>
+
+#include "ClockSource.h"
+#include "ScheduleClock.h"
+
+// Decides when the overlay actually needs to be drawn again. Instead of redrawing on a fixed
+// interval the main loop asks for the next visible change (a second or minute boundary, an
+// animation step, ...) and blocks on the SDL event queue until then.
+class FrameScheduler {
+    const ClockSource* clockSource;
+    Uint32 wakeEventType = 0;
+    bool dirty = true;
+    bool visible = true;
+    Uint64 deadlineNS = 0;
+public:
+    FrameScheduler(SDL_Window* window, const ClockSource* clockSource);
+    void Invalidate() { this->dirty = true; }
+    void ScheduleIn(Uint64 delayNS);
+    void ScheduleNextVisibleChange(ScheduleClock& scheduleClock, bool everySecond);
+    [[nodiscard]] bool IsVisible() const { return this->visible; }
+    bool IsFrameDue();
+    void WaitForNextFrame() const;
+    void RequestWakeup() const;
+    [[nodiscard]] bool IsWakeEvent(const SDL_Event* event) const;
+    void OnWindowEvent(const SDL_Event* event);
+};
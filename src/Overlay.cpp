@@ -0,0 +1,157 @@
+#include "Overlay.h"
+
+#include <string>
+
+#include "Trace.h"
+
+// pixel sizes at a display scale of 1, the fonts are opened at the scaled size instead of stretching the textures
+static constexpr float TEXT_FONT_SIZE = 32 * 0.43f;
+static constexpr float LARGE_BELL_FONT_SIZE = 32 * 0.75f;
+
+Overlay::Overlay(SDL_Renderer *renderer, TextManager *textManager, Settings *settings, FontCache *fontCache) {
+    this->renderer = renderer;
+    this->textManager = textManager;
+    this->settings = settings;
+    this->fontCache = fontCache;
+}
+
+void Overlay::HoldFonts(const float textSize, const float bellSize) {
+    if (textSize == heldTextSize && bellSize == heldBellSize) {
+        return;
+    }
+    // acquire before releasing, so a size the old and new scale share stays open
+    fontCache->Acquire(textSize);
+    fontCache->Acquire(bellSize);
+    if (heldTextSize > 0) {
+        fontCache->Release(heldTextSize);
+        fontCache->Release(heldBellSize);
+    }
+    heldTextSize = textSize;
+    heldBellSize = bellSize;
+}
+
+Overlay_Frame Overlay::Render(const Schedule *schedule, const int secondsOfDay, const float scale,
+                              const int windowWidth, const int windowHeight) {
+    SDL_Color fontColor;
+    switch (settings->theme) {
+        case LIGHT:
+            fontColor = {0, 0, 0, 255};
+            break;
+        case DARK:
+        default:
+            fontColor = {255, 255, 255, 255};
+            break;
+    }
+
+    Overlay_Frame frame = {.hasSchedule = schedule != nullptr, .changesEverySecond = false};
+
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+
+    SDL_RenderClear(renderer);
+
+    const float textSize = TEXT_FONT_SIZE * scale;
+    HoldFonts(textSize, settings->largeText ? LARGE_BELL_FONT_SIZE * scale : textSize);
+    TTF_Font *font = fontCache->Get(heldTextSize);
+    TTF_Font *bellFont = fontCache->Get(heldBellSize);
+    if (font == nullptr || bellFont == nullptr) {
+        SDL_RenderPresent(renderer);
+        return frame;
+    }
+
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    // ReSharper disable once CppUseStructuredBinding
+    const SDL_FRect dimensions = textManager->RenderText(font, "dimensionText", "A", INT32_MAX, INT32_MAX, fontColor, 1);
+
+    // a cached schedule stays on screen while a fresh one is being fetched
+    if (schedule != nullptr) {
+        const Schedule_State state = schedule->GetState(secondsOfDay, scheduleCursor);
+        const int timeLeft = state.secondsLeft;
+        const int totalEventTime = state.eventSeconds;
+
+        const float progress = totalEventTime > 0
+                                       ? (static_cast<float>(totalEventTime) - static_cast<float>(timeLeft)) /
+                                                 static_cast<float>(totalEventTime)
+                                       : 0.0f;
+        float percentage = progress * 100;
+        const std::string &dayType = schedule->GetData().msg;
+        Overlay_Text<128> &event = frame.event;
+        if (settings->showPercentage) {
+            event.Append("{:.2f}% - ", percentage);
+        }
+        event.size += schedule->GetCurrentEvent(state, event.Free()).size();
+        event.Append(", Time Left: ");
+        const int hoursLeft = timeLeft / 60 / 60;
+        const int minLeft = (timeLeft - hoursLeft * 60 * 60) / 60;
+        const int secsLeft = timeLeft - minLeft * 60 - hoursLeft * 60 * 60;
+        const SDL_Color schedColor = schedule->CalculateTextColor(timeLeft);
+        frame.textColor = schedColor;
+        frame.progress = progress;
+
+        // large text only shows the countdown
+        SDL_FRect eventName = {5, 0, 0, 0};
+        if (!settings->largeText) {
+            // ReSharper disable once CppUseStructuredBinding
+            const SDL_FRect dayTypeText = textManager->RenderText(font, "display.dayType", dayType, 10, static_cast<float>(windowHeight) - 6 - dimensions.h * 2, schedColor, 1);
+
+            eventName = textManager->RenderText(font, "display.classTimeLeft.eventName",
+                    event.View(), 10, static_cast<float>(windowHeight) - 7 - dayTypeText.h, schedColor, 1);
+        }
+
+
+        Overlay_Text<16> hrsMins;
+        if (hoursLeft != 0) {
+            hrsMins.Append("{:02}:{:02}", hoursLeft, minLeft);
+        } else {
+            hrsMins.Append("{:02}", minLeft);
+        }
+        frame.countdown.Append("{}", hrsMins.View());
+
+        // ReSharper disable once CppUseStructuredBinding
+        const SDL_FRect hrsMinsDimensions =
+                textManager->RenderNumericText(bellFont, "display.classTimeLeft.HrsMins", hrsMins.View(), eventName.x + eventName.w,
+                                               eventName.y, schedColor, 1);
+
+        if (settings->showSeconds) {
+            Overlay_Text<8> secs;
+            secs.Append(":{:02}", secsLeft);
+            frame.countdown.Append("{}", secs.View());
+            textManager->RenderNumericText(bellFont, "display.classTimeLeft.Seconds", secs.View(),
+                                           hrsMinsDimensions.x + hrsMinsDimensions.w, hrsMinsDimensions.y, {schedColor.r, schedColor.g, schedColor.b, 100}, 1);
+        }
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+        if (settings->showProgressBar) {
+            // ReSharper disable once CppUseStructuredBinding
+            const SDL_Color progressBarColor = schedule->CalculateProgressBarColor(timeLeft);
+            SDL_SetRenderDrawColor(renderer, progressBarColor.r, progressBarColor.g, progressBarColor.b, 100);
+            const auto progressBarBG = SDL_FRect{0, static_cast<float>(windowHeight) - scale * 2, static_cast<float>(windowWidth), scale * 2};
+            SDL_RenderFillRect(renderer, &progressBarBG);
+            SDL_SetRenderDrawColor(renderer, progressBarColor.r, progressBarColor.g, progressBarColor.b, progressBarColor.a);
+            const auto progressBar = SDL_FRect{0, static_cast<float>(windowHeight) - scale * 2,
+                static_cast<float>(windowWidth) * progress, scale * 2 + 10};
+            SDL_RenderFillRect(renderer, &progressBar);
+        }
+        // after the last event the countdown sits at zero until the next day's schedule, nothing ticks
+        const bool counting = state.kind == SCHED_INTERVAL_EVENT || state.kind == SCHED_INTERVAL_PASSING;
+        frame.changesEverySecond = counting && (settings->showSeconds || settings->showPercentage ||
+                                                settings->showProgressBar || timeLeft <= 60);
+    } else {
+        Overlay_Text<32> loadingText;
+        loadingText.Append("Fetching Schedule{:.<{}}", "", elipsesCount);
+        textManager->RenderText(font, "display.loading", loadingText.View(),
+            10, static_cast<float>(windowHeight) - 7 - dimensions.h, fontColor, 1);
+        elipsesTimer += 200;
+        if (elipsesTimer > 400) {
+            elipsesCount++;
+            elipsesTimer = 0;
+        }
+        if (elipsesCount > 3) {
+            elipsesCount = 0;
+        }
+    }
+
+    {
+        TRACE_SCOPE("RenderPresent");
+        SDL_RenderPresent(renderer);
+    }
+    return frame;
+}
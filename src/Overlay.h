@@ -0,0 +1,57 @@
+#pragma once
+#include <SDL3/SDL_render.h>
+#include <SDL3_ttf/SDL_ttf.h>
+#include <array>
+#include <format>
+#include <span>
+#include <string_view>
+
+#include "FontCache.h"
+#include "Schedule.h"
+#include "Settings.h"
+#include "TextManager.h"
+
+// Fixed-capacity text for one frame, so formatting the display strings never allocates. Text past the capacity is
+// cut off.
+template<size_t Capacity>
+struct Overlay_Text {
+    std::array<char, Capacity> buffer{};
+    size_t size = 0;
+    template<typename... Args>
+    void Append(std::format_string<Args...> format, Args&&... args) {
+        const auto result = std::format_to_n(buffer.data() + size, static_cast<std::ptrdiff_t>(Capacity - size), format,
+                                             std::forward<Args>(args)...);
+        size = static_cast<size_t>(result.out - buffer.data());
+    }
+    [[nodiscard]] std::span<char> Free() { return {buffer.data() + size, Capacity - size}; }
+    [[nodiscard]] std::string_view View() const { return {buffer.data(), size}; }
+};
+
+struct Overlay_Frame {
+    bool hasSchedule;
+    bool changesEverySecond;
+    // what the schedule line showed, so the headless check can compare it without reading pixels back
+    Overlay_Text<128> event;
+    Overlay_Text<16> countdown;
+    SDL_Color textColor = {};
+    float progress = 0;
+};
+
+// Draws the bell schedule overlay. It only depends on a renderer and the time it is given, so the same code
+// drives the real window and the headless benchmark.
+class Overlay {
+    SDL_Renderer* renderer;
+    TextManager* textManager;
+    Settings* settings;
+    FontCache* fontCache;
+    // sizes acquired from the font cache for the current scale and text size, 0 before the first frame
+    float heldTextSize = 0;
+    float heldBellSize = 0;
+    void HoldFonts(float textSize, float bellSize);
+    size_t scheduleCursor = 0;
+    int elipsesCount = 0;
+    int elipsesTimer = 0;
+public:
+    Overlay(SDL_Renderer* renderer, TextManager* textManager, Settings* settings, FontCache* fontCache);
+    Overlay_Frame Render(const Schedule* schedule, int secondsOfDay, float scale, int windowWidth, int windowHeight);
+};
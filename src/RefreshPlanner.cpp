@@ -0,0 +1,30 @@
+#include "RefreshPlanner.h"
+
+#include <algorithm>
+
+// give the server a few seconds after midnight to make sure it returns the new day's schedule
+static constexpr auto ROLLOVER_GRACE = std::chrono::seconds(5);
+
+RefreshPlanner::RefreshPlanner(const ScheduleClock *clock, const std::chrono::seconds refreshWindow) :
+    clock(clock), refreshWindow(refreshWindow), random(std::random_device{}()) {}
+
+void RefreshPlanner::Plan(const long long scheduleDay) {
+    if (hasPlan && plannedDay == scheduleDay) {
+        return;
+    }
+    const auto nextMidnight = clock->MidnightOf(scheduleDay + 1);
+    std::uniform_int_distribution<long long> jitter(
+            0, std::chrono::duration_cast<std::chrono::milliseconds>(refreshWindow).count());
+    refreshAt = nextMidnight + ROLLOVER_GRACE + std::chrono::milliseconds(jitter(random));
+    plannedDay = scheduleDay;
+    hasPlan = true;
+}
+
+bool RefreshPlanner::IsRefreshDue(const std::chrono::system_clock::time_point now) const {
+    return hasPlan && now >= refreshAt;
+}
+
+std::chrono::nanoseconds RefreshPlanner::TimeUntilRefresh(const std::chrono::system_clock::time_point now) const {
+    return std::max(std::chrono::nanoseconds::zero(),
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(refreshAt - now));
+}
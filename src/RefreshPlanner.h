@@ -0,0 +1,21 @@
+#pragma once
+#include <chrono>
+#include <random>
+
+#include "ScheduleClock.h"
+
+// Works out once per schedule day when the next schedule should be fetched. Every overlay picks a random
+// moment inside the refresh window after midnight, so a building full of them doesn't hit the API at once.
+class RefreshPlanner {
+    const ScheduleClock* clock;
+    std::chrono::seconds refreshWindow;
+    std::mt19937 random;
+    bool hasPlan = false;
+    long long plannedDay = 0;
+    std::chrono::system_clock::time_point refreshAt{};
+public:
+    RefreshPlanner(const ScheduleClock* clock, std::chrono::seconds refreshWindow);
+    void Plan(long long scheduleDay);
+    [[nodiscard]] bool IsRefreshDue(std::chrono::system_clock::time_point now) const;
+    [[nodiscard]] std::chrono::nanoseconds TimeUntilRefresh(std::chrono::system_clock::time_point now) const;
+};
@@ -1,185 +1,98 @@
 #include "Schedule.h"
 
-#include <chrono>
-#include <nlohmann/json.hpp>
-using json = nlohmann::json;
-
-static const auto GMT_OFFSET = std::chrono::hours(-5);
-
-static const auto EVENT_STRING_NOTHING = "Nothing";
-static const auto EVENT_STRING_PERIOD1 = "Period 1";
-static const auto EVENT_STRING_PERIOD2 = "Period 2";
-static const auto EVENT_STRING_PERIOD3 = "Period 3";
-static const auto EVENT_STRING_PERIOD4 = "Period 4";
-static const auto EVENT_STRING_PERIOD5 = "Period 5";
-static const auto EVENT_STRING_PERIOD6 = "Period 6";
-static const auto EVENT_STRING_PERIOD7 = "Period 7";
-static const auto EVENT_STRING_MORNING = "Morning";
-static const auto EVENT_STRING_WELCOME = "Welcome";
-static const auto EVENT_STRING_LUNCH = "Lunch";
-static const auto EVENT_STRING_HOMEROOM = "Homeroom";
-static const auto EVENT_STRING_DISMISSAL = "Dismissal";
-static const auto EVENT_STRING_AFTER_SCHOOL = "After School";
-static const auto EVENT_STRING_END = "End";
-static const auto EVENT_STRING_BREAK = "Break";
-static const auto EVENT_STRING_PSAT_SAT = "PSAT/SAT";
+#include <algorithm>
+#include <format>
 
-static constexpr auto EVENT_NOTHING = 0;
-static constexpr auto EVENT_PERIOD1 = 1;
-static constexpr auto EVENT_PERIOD2 = 2;
-static constexpr auto EVENT_PERIOD3 = 3;
-static constexpr auto EVENT_PERIOD4 = 4;
-static constexpr auto EVENT_PERIOD5 = 5;
-static constexpr auto EVENT_PERIOD6 = 6;
-static constexpr auto EVENT_PERIOD7 = 7;
-static constexpr auto EVENT_MORNING = 100;
-static constexpr auto EVENT_WELCOME = 101;
-static constexpr auto EVENT_LUNCH = 102;
-static constexpr auto EVENT_HOMEROOM = 103;
-static constexpr auto EVENT_DISMISSAL = 104;
-static constexpr auto EVENT_AFTER_SCHOOL = 105;
-static constexpr auto EVENT_END = 106;
-static constexpr auto EVENT_BREAK = 107;
-static constexpr auto EVENT_PSAT_SAT = 110;
-
-int Sched_GetCurrentTimeSeconds() {
-    const auto currentTime = std::chrono::system_clock::now();
-    auto tp = currentTime.time_since_epoch();
-    tp += GMT_OFFSET;
-    tp -= std::chrono::duration_cast<std::chrono::days>(tp);
-    const auto s = std::chrono::duration_cast<std::chrono::seconds>(tp);
-
-    return static_cast<int>(s.count());
-}
-
-const char *Schedule::GetEventName(const int event) const {
-    switch (event) {
-        case EVENT_NOTHING:
-            return GetEventAliasName(EVENT_STRING_NOTHING);
-        case EVENT_PERIOD1:
-            return GetEventAliasName(EVENT_STRING_PERIOD1);
-        case EVENT_PERIOD2:
-            return GetEventAliasName(EVENT_STRING_PERIOD2);
-        case EVENT_PERIOD3:
-            return GetEventAliasName(EVENT_STRING_PERIOD3);
-        case EVENT_PERIOD4:
-            return GetEventAliasName(EVENT_STRING_PERIOD4);
-        case EVENT_PERIOD5:
-            return GetEventAliasName(EVENT_STRING_PERIOD5);
-        case EVENT_PERIOD6:
-            return GetEventAliasName(EVENT_STRING_PERIOD6);
-        case EVENT_PERIOD7:
-            return GetEventAliasName(EVENT_STRING_PERIOD7);
-        case EVENT_MORNING:
-            return GetEventAliasName(EVENT_STRING_MORNING);
-        case EVENT_WELCOME:
-            return GetEventAliasName(EVENT_STRING_WELCOME);
-        case EVENT_LUNCH:
-            return GetEventAliasName(EVENT_STRING_LUNCH);
-        case EVENT_HOMEROOM:
-            return GetEventAliasName(EVENT_STRING_HOMEROOM);
-        case EVENT_DISMISSAL:
-            return GetEventAliasName(EVENT_STRING_DISMISSAL);
-        case EVENT_AFTER_SCHOOL:
-            return GetEventAliasName(EVENT_STRING_AFTER_SCHOOL);
-        case EVENT_END:
-            return GetEventAliasName(EVENT_STRING_END);
-        case EVENT_BREAK:
-            return GetEventAliasName(EVENT_STRING_BREAK);
-        case EVENT_PSAT_SAT:
-            return GetEventAliasName(EVENT_STRING_PSAT_SAT);
-        default:
-            return GetEventAliasName(EVENT_STRING_NOTHING);
-    }
-}
+#include "Trace.h"
 
-const char *Schedule::GetEventAliasName(const char *eventName) const {
-    if (settings->periodAliases.contains(eventName)) {
-        return settings->periodAliases[eventName].c_str();
-    }
-    return eventName;
-}
-
-Sched_Event Sched_ConvertEvent(json eventJson) {
-    const int startS = static_cast<int>(eventJson[0]) * 60 * 60 + static_cast<int>(eventJson[1]) * 60;
-    const int endS = static_cast<int>(eventJson[3]) * 60 * 60 + static_cast<int>(eventJson[4]) * 60;
-    return Sched_Event{eventJson[2], startS, endS};
-}
+// the code of the interval after the last event of the day
+static constexpr auto EVENT_NOTHING = 0;
 
-Schedule::Schedule(nlohmann::json json, Settings* settings) {
-    this->status = json["status"];
-    this->responseTime = std::chrono::system_clock::now().time_since_epoch() + GMT_OFFSET;
-    std::vector<std::vector<Sched_Event>> schedule;
-    int iteration = 0;
-    for (auto i: json["data"]["schedule"]) {
-        std::vector<Sched_Event> events;
-        for (auto j: json["data"]["schedule"][iteration]) { // NOLINT(*-for-range-copy)
-            events.push_back(Sched_ConvertEvent(j));
-        }
-        schedule.push_back(events);
-        iteration++;
-    }
-    this->data = {.id = json["data"]["id"], .msg = json["data"]["msg"], .schedule = schedule};
+Schedule::Schedule(std::string status, Schedule_Data data, const long long day, Settings *settings) {
+    this->status = std::move(status);
+    this->day = day;
+    this->data = std::move(data);
     this->settings = settings;
+    BuildTimelines();
 }
 
-int Schedule::GetSecondsLeft() {
-    const int seconds = Sched_GetCurrentTimeSeconds();
-    int secondsLeft = 0;
-    for (auto [event, startS, endS]: this->data.schedule.at(this->settings->currentLunch)) {
-        if (seconds >= startS && seconds <= endS) {
-            secondsLeft = endS - seconds;
-            break;
+void Schedule::BuildTimelines() {
+    static constexpr int DAY_SECONDS = 24 * 60 * 60;
+    this->timelines.clear();
+    for (const auto &track: this->data.schedule) {
+        std::vector<Sched_Event> events = track;
+        std::ranges::stable_sort(events, {}, &Sched_Event::startS);
+
+        std::vector<Sched_Interval> timeline;
+        timeline.reserve(events.size() * 2 + 1);
+        int lastEndS = 0;
+        for (const auto &[event, startS, endS]: events) {
+            // overlapping events are clipped so the timeline stays strictly ordered
+            const int clippedStartS = std::clamp(startS, lastEndS, DAY_SECONDS);
+            const int clippedEndS = std::clamp(endS, clippedStartS, DAY_SECONDS);
+            if (clippedEndS == clippedStartS) {
+                continue;
+            }
+            if (!timeline.empty() && timeline.back().kind == SCHED_INTERVAL_EVENT) {
+                timeline.back().nextEvent = event;
+            }
+            if (clippedStartS > lastEndS) {
+                timeline.push_back({SCHED_INTERVAL_PASSING, event, event, lastEndS, clippedStartS});
+            }
+            timeline.push_back({SCHED_INTERVAL_EVENT, event, -1, clippedStartS, clippedEndS});
+            lastEndS = clippedEndS;
         }
-        if (seconds < endS && seconds < startS) {
-            secondsLeft = startS - seconds;
-            break;
+        if (lastEndS < DAY_SECONDS) {
+            timeline.push_back({SCHED_INTERVAL_DONE, EVENT_NOTHING, -1, lastEndS, DAY_SECONDS});
         }
+        this->timelines.push_back(std::move(timeline));
     }
-    return secondsLeft;
 }
 
-int Schedule::GetEventSeconds() {
-    const int seconds = Sched_GetCurrentTimeSeconds();
-    int eventSeconds = 0;
-    int lastEndS = 0;
-    for (auto [event, startS, endS]: this->data.schedule.at(this->settings->currentLunch)) {
-        if (seconds >= startS && seconds <= endS) {
-            eventSeconds = endS - startS;
+const Sched_Interval &Schedule::FindInterval(const size_t track, const int seconds, size_t &cursor) const {
+    const auto &timeline = this->timelines.at(track);
+    // time normally only moves forward by a second or so between frames, so walk the cursor first
+    for (int step = 0; step < 2 && cursor < timeline.size(); ++step) {
+        if (seconds < timeline[cursor].startS) {
             break;
         }
-        if (seconds < endS && seconds < startS) {
-            eventSeconds = startS - lastEndS;
-            break;
+        if (seconds < timeline[cursor].endS) {
+            return timeline[cursor];
         }
-        lastEndS = endS;
+        cursor++;
     }
-    return eventSeconds;
+    const auto it = std::ranges::upper_bound(timeline, seconds, {}, &Sched_Interval::startS);
+    cursor = it == timeline.begin() ? 0 : static_cast<size_t>(it - timeline.begin()) - 1;
+    return timeline[cursor];
 }
 
-std::string Schedule::GetCurrentEvent() {
-    const int seconds = Sched_GetCurrentTimeSeconds();
-    std::string eventName;
-    for (auto [event, startS, endS]: this->data.schedule.at(this->settings->currentLunch)) {
-        if (seconds > startS && seconds < endS) {
-            eventName = GetEventName(event);
-            break;
-        }
-        if (seconds < endS && seconds < startS) {
-            eventName = "Go to " + std::string(GetEventName(event));
-            break;
-        }
+Schedule_State Schedule::GetState(int seconds, size_t &cursor) const {
+    TRACE_SCOPE("Schedule query");
+    if (this->timelines.empty()) {
+        return {SCHED_INTERVAL_DONE, EVENT_NOTHING, -1, 0, 0};
+    }
+    seconds = std::clamp(seconds, 0, 24 * 60 * 60 - 1);
+    // the settings are clamped to the tracks of the schedule on screen, a newer one can still have fewer
+    const size_t track = std::min(static_cast<size_t>(std::max(this->settings->currentLunch, 0)),
+                                  this->timelines.size() - 1);
+    const auto &[kind, event, nextEvent, startS, endS] = FindInterval(track, seconds, cursor);
+    if (kind == SCHED_INTERVAL_DONE) {
+        return {kind, event, -1, 0, 0};
     }
-    return eventName;
+    return {kind, event, nextEvent, endS - seconds, endS - startS};
 }
 
-std::string Schedule::PadTime(const int time, const int padLength) {
-    if (std::string str = std::to_string(time); str.length() < padLength) {
-        str.insert(0, padLength - str.length(), '0');
-        return str;
-    } else {
-        return str;
+std::string_view Schedule::GetCurrentEvent(const Schedule_State &state, const std::span<char> buffer) const {
+    if (state.kind != SCHED_INTERVAL_EVENT && state.kind != SCHED_INTERVAL_PASSING) {
+        return {};
     }
+    const auto size = static_cast<std::ptrdiff_t>(buffer.size());
+    const std::string_view prefix = state.kind == SCHED_INTERVAL_PASSING ? "Go to " : "";
+    // codes the name table doesn't know yet still get a readable name
+    const std::string *name = settings->GetEventNames().Get(state.event);
+    const auto result = name != nullptr ? std::format_to_n(buffer.data(), size, "{}{}", prefix, *name)
+                                        : std::format_to_n(buffer.data(), size, "{}Event {}", prefix, state.event);
+    return {buffer.data(), result.out};
 }
 
 SDL_Color Schedule::CalculateTextColor(const int secondsRemaining) const {
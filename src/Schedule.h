@@ -1,7 +1,9 @@
 #pragma once
 #include <SDL3/SDL_pixels.h>
-#include <chrono>
-#include <nlohmann/json_fwd.hpp>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include "Settings.h"
 
@@ -11,30 +13,57 @@ struct Sched_Event {
     int endS;
 };
 
+enum Sched_IntervalKind {
+    SCHED_INTERVAL_EVENT = 0,
+    SCHED_INTERVAL_PASSING = 1,
+    SCHED_INTERVAL_DONE = 2
+};
+
+// One entry of a track's timeline. Timelines are sorted, never overlap and cover the whole day,
+// the time before an event is a passing interval pointing at the event that is coming up.
+struct Sched_Interval {
+    Sched_IntervalKind kind;
+    int event;
+    int nextEvent;
+    int startS;
+    int endS;
+};
+
+// Everything the overlay needs for one frame, resolved from a single timestamp.
+struct Schedule_State {
+    Sched_IntervalKind kind;
+    int event;
+    int upcomingEvent;
+    int secondsLeft;
+    int eventSeconds;
+};
+
 struct Schedule_Data {
     std::string id;
     std::string msg;
     std::vector<std::vector<Sched_Event>> schedule;
 };
 
+// A parsed schedule. Once constructed it is never modified, so one instance can be built on the network thread
+// and shared with the render loop; per-reader state like the timeline cursor is owned by the caller.
 class Schedule {
     std::string status;
-    std::chrono::duration<long long, std::ratio<1, 1000000000>> responseTime{};
+    // local day the schedule was fetched for, see ScheduleClock
+    long long day = 0;
     Schedule_Data data;
+    std::vector<std::vector<Sched_Interval>> timelines;
     Settings* settings;
-    [[nodiscard]] const char* GetEventName(int event) const;
-    const char* GetEventAliasName(const char* eventName) const;
+    void BuildTimelines();
+    [[nodiscard]] const Sched_Interval& FindInterval(size_t track, int seconds, size_t& cursor) const;
 public:
-    explicit Schedule(nlohmann::json json, Settings* settings);
-    std::string GetCurrentEvent();
-    std::string GetStatus() { return this->status; }
-    [[nodiscard]] std::chrono::duration<long long, std::ratio<1, 1000000000>> GetResponseTime() const {
-        return this->responseTime;
-    }
-    Schedule_Data GetData() { return this->data; }
-    int GetSecondsLeft();
-    int GetEventSeconds();
-    static std::string PadTime(int time, int padLength);
+    Schedule(std::string status, Schedule_Data data, long long day, Settings* settings);
+    [[nodiscard]] Schedule_State GetState(int seconds, size_t& cursor) const;
+    // writes the event text into buffer and returns the written part, text that doesn't fit is cut off
+    [[nodiscard]] std::string_view GetCurrentEvent(const Schedule_State& state, std::span<char> buffer) const;
+    [[nodiscard]] const std::string& GetStatus() const { return this->status; }
+    [[nodiscard]] long long GetDay() const { return this->day; }
+    [[nodiscard]] int GetTrackCount() const { return static_cast<int>(this->timelines.size()); }
+    [[nodiscard]] const Schedule_Data& GetData() const { return this->data; }
     [[nodiscard]] SDL_Color CalculateTextColor(int secondsRemaining) const;
     [[nodiscard]] SDL_Color CalculateProgressBarColor(int secondsRemaining) const;
 };
\ No newline at end of file
@@ -0,0 +1,48 @@
+#include "ScheduleCache.h"
+
+#include <SDL3/SDL_log.h>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+// The cache file is the day the response was fetched on, a newline and then the raw response body, so it can be
+// handed to the same parser as a fresh response.
+
+ScheduleCache::ScheduleCache(const std::string &cacheFilePath) {
+    this->cacheFilePath = cacheFilePath;
+}
+
+bool ScheduleCache::Load(const long long day, std::string &response) const {
+    if (!std::filesystem::exists(cacheFilePath)) return false;
+
+    std::ifstream cacheFile(cacheFilePath, std::ios::binary);
+    long long cachedDay = 0;
+    if (!(cacheFile >> cachedDay) || cacheFile.get() != '\n') {
+        SDL_Log("Ignoring unreadable schedule cache %s", cacheFilePath.c_str());
+        return false;
+    }
+    if (cachedDay != day) {
+        return false;
+    }
+    response.assign(std::istreambuf_iterator(cacheFile), std::istreambuf_iterator<char>());
+    return true;
+}
+
+void ScheduleCache::Store(const long long day, const std::string_view response) const {
+    // write to a temporary file first so a crash never leaves a half written cache behind
+    const std::string tempFilePath = cacheFilePath + ".tmp";
+    {
+        std::ofstream cacheFile(tempFilePath, std::ios::binary | std::ios::trunc);
+        cacheFile << day << '\n';
+        cacheFile.write(response.data(), static_cast<std::streamsize>(response.size()));
+        if (!cacheFile.good()) {
+            SDL_Log("Couldn't write schedule cache %s", tempFilePath.c_str());
+            return;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(tempFilePath, cacheFilePath, error);
+    if (error) {
+        SDL_Log("Couldn't replace schedule cache %s: %s", cacheFilePath.c_str(), error.message().c_str());
+    }
+}
@@ -0,0 +1,12 @@
+#pragma once
+#include <string>
+#include <string_view>
+
+// Keeps the last good schedule response on disk so the overlay can start (or keep running) without the network.
+class ScheduleCache {
+    std::string cacheFilePath;
+public:
+    explicit ScheduleCache(const std::string &cacheFilePath);
+    [[nodiscard]] bool Load(long long day, std::string &response) const;
+    void Store(long long day, std::string_view response) const;
+};
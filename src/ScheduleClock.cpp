@@ -0,0 +1,89 @@
+#include "ScheduleClock.h"
+
+#include <SDL3/SDL_log.h>
+#include <algorithm>
+#include <stdexcept>
+
+// the wall clock can be adjusted or the machine suspended, so the steady anchor is never trusted for longer
+static constexpr auto MAX_ANCHOR_AGE = std::chrono::minutes(1);
+
+ScheduleClock::ScheduleClock(const std::string &timeZone, const ClockSource *source) :
+    source(source), fallbackOffset(std::chrono::hours(-5)) {
+    try {
+        this->zone = std::chrono::locate_zone(timeZone);
+    } catch (const std::runtime_error &error) {
+        SDL_Log("Unknown time zone %s (%s), using the system time zone", timeZone.c_str(), error.what());
+        try {
+            this->zone = std::chrono::current_zone();
+        } catch (const std::runtime_error &) {
+            SDL_Log("Time zone database unavailable, using a fixed UTC-5 offset");
+        }
+    }
+    Refresh();
+}
+
+long long ScheduleClock::DayOf(const std::chrono::system_clock::time_point time) const {
+    if (zone == nullptr) {
+        return std::chrono::floor<std::chrono::days>(time.time_since_epoch() + fallbackOffset).count();
+    }
+    return std::chrono::floor<std::chrono::days>(zone->to_local(time)).time_since_epoch().count();
+}
+
+std::chrono::system_clock::time_point ScheduleClock::MidnightOf(const long long day) const {
+    if (zone == nullptr) {
+        return std::chrono::sys_days(std::chrono::days(day)) - fallbackOffset;
+    }
+    // a few zones skip or repeat midnight itself when DST starts or ends
+    return zone->to_sys(std::chrono::local_days(std::chrono::days(day)), std::chrono::choose::earliest);
+}
+
+void ScheduleClock::Refresh() {
+    const auto steadyNow = source->SteadyNow();
+    const auto now = source->Now();
+
+    std::chrono::seconds offset = fallbackOffset;
+    std::chrono::system_clock::duration span = MAX_ANCHOR_AGE;
+    if (zone != nullptr) {
+        const std::chrono::sys_info info = zone->get_info(now);
+        offset = info.offset;
+        // the last transition of a zone ends at sys_seconds::max(), so compare in seconds before converting
+        if (const auto untilTransition = info.end - std::chrono::floor<std::chrono::seconds>(now);
+            untilTransition < MAX_ANCHOR_AGE) {
+            span = untilTransition;
+        }
+    }
+    const auto localNow = now + offset;
+    const auto localDay = std::chrono::floor<std::chrono::days>(localNow);
+    span = std::min<std::chrono::system_clock::duration>(span, localDay + std::chrono::days(1) - localNow);
+
+    this->anchor = steadyNow;
+    this->anchorDay = localDay.time_since_epoch().count();
+    this->anchorTimeOfDay = localNow - localDay;
+    this->validUntil = steadyNow + span;
+}
+
+int ScheduleClock::GetSecondsOfDay() {
+    auto steadyNow = source->SteadyNow();
+    if (steadyNow >= validUntil) {
+        Refresh();
+        steadyNow = anchor;
+    }
+    return static_cast<int>(std::chrono::floor<std::chrono::seconds>(anchorTimeOfDay + (steadyNow - anchor)).count());
+}
+
+std::chrono::nanoseconds ScheduleClock::TimeUntilBoundary(const std::chrono::nanoseconds period) {
+    auto steadyNow = source->SteadyNow();
+    if (steadyNow >= validUntil) {
+        Refresh();
+        steadyNow = anchor;
+    }
+    const std::chrono::nanoseconds timeOfDay = anchorTimeOfDay + (steadyNow - anchor);
+    return period - timeOfDay % period;
+}
+
+long long ScheduleClock::GetDay() {
+    if (source->SteadyNow() >= validUntil) {
+        Refresh();
+    }
+    return anchorDay;
+}
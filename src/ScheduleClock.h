@@ -0,0 +1,29 @@
+#pragma once
+#include <chrono>
+#include <string>
+
+#include "ClockSource.h"
+
+// Local time of the configured IANA zone. The zone is only consulted once per local day or DST transition, in
+// between the seconds of the day are a single subtraction from a steady clock anchor.
+// GetSecondsOfDay and GetDay update the cached span and belong to the main thread, DayOf can be called anywhere.
+class ScheduleClock {
+    const ClockSource* source;
+    const std::chrono::time_zone* zone = nullptr;
+    // used when the zone database isn't available
+    std::chrono::seconds fallbackOffset;
+    std::chrono::steady_clock::time_point anchor{};
+    std::chrono::steady_clock::time_point validUntil{};
+    // local time of day and day number at the anchor, the UTC offset can't change before validUntil
+    std::chrono::nanoseconds anchorTimeOfDay{};
+    long long anchorDay = 0;
+    void Refresh();
+public:
+    ScheduleClock(const std::string& timeZone, const ClockSource* source);
+    [[nodiscard]] long long DayOf(std::chrono::system_clock::time_point time) const;
+    [[nodiscard]] std::chrono::system_clock::time_point MidnightOf(long long day) const;
+    int GetSecondsOfDay();
+    long long GetDay();
+    // time left until the time of day GetSecondsOfDay counts from next reaches a multiple of period
+    std::chrono::nanoseconds TimeUntilBoundary(std::chrono::nanoseconds period);
+};
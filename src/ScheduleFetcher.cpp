@@ -0,0 +1,132 @@
+#include "ScheduleFetcher.h"
+
+#include <SDL3/SDL_log.h>
+#include <algorithm>
+#include <charconv>
+#include <cpr/cpr.h>
+#include <fstream>
+#include <iterator>
+
+#include "Trace.h"
+
+// never wait longer than this, even if the server asks for it in Retry-After
+static constexpr auto MAX_RETRY_AFTER = std::chrono::hours(1);
+// urls with this prefix are read from disk, which lets a simulation replay a saved response
+static constexpr std::string_view FILE_URL_PREFIX = "file://";
+
+ScheduleFetcher::ScheduleFetcher(std::string url, ResponseHandler onResponse, const ScheduleFetcher_Options options) :
+    url(std::move(url)), onResponse(std::move(onResponse)), options(options), random(std::random_device{}()) {
+    this->worker = std::thread(&ScheduleFetcher::Run, this);
+}
+
+ScheduleFetcher::~ScheduleFetcher() {
+    Cancel();
+}
+
+void ScheduleFetcher::Fetch() {
+    {
+        std::lock_guard lock(mutex);
+        if (fetching || cancelled) {
+            return;
+        }
+        fetching = true;
+        fetchRequested = true;
+    }
+    wakeup.notify_all();
+}
+
+void ScheduleFetcher::Cancel() {
+    {
+        std::lock_guard lock(mutex);
+        cancelled = true;
+    }
+    wakeup.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void ScheduleFetcher::Run() {
+    while (true) {
+        {
+            std::unique_lock lock(mutex);
+            wakeup.wait(lock, [this] { return fetchRequested || cancelled; });
+            if (cancelled) {
+                return;
+            }
+            fetchRequested = false;
+        }
+        for (int attempt = 0; !cancelled; ++attempt) {
+            std::chrono::milliseconds retryDelay = BackoffDelay(attempt);
+            if (TryFetch(attempt, retryDelay)) {
+                break;
+            }
+            SDL_Log("Retrying schedule fetch in %lld ms", static_cast<long long>(retryDelay.count()));
+            if (!WaitFor(retryDelay)) {
+                return;
+            }
+        }
+        fetching = false;
+    }
+}
+
+bool ScheduleFetcher::TryFetch(const int attempt, std::chrono::milliseconds &retryDelay) {
+    if (url.starts_with(FILE_URL_PREFIX)) {
+        const std::string path = url.substr(FILE_URL_PREFIX.size());
+        std::string text;
+        {
+            TRACE_SCOPE("Schedule fetch");
+            std::ifstream file(path, std::ios::binary);
+            if (!file) {
+                SDL_Log("Failed to fetch schedule (attempt %d)! Error: Couldn't open %s", attempt + 1, path.c_str());
+                return false;
+            }
+            text.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        }
+        return onResponse(text);
+    }
+    cpr::Response res;
+    {
+        TRACE_SCOPE("Schedule fetch");
+        res = cpr::Get(cpr::Url{url}, cpr::Timeout{options.requestTimeout},
+                       cpr::ProgressCallback([this](cpr::cpr_off_t, cpr::cpr_off_t, cpr::cpr_off_t, cpr::cpr_off_t,
+                                                    intptr_t) { return !cancelled; }));
+    }
+    if (cancelled) {
+        return false;
+    }
+    if (res.error) {
+        SDL_Log("Failed to fetch schedule (attempt %d)! Error: %s", attempt + 1, res.error.message.c_str());
+        return false;
+    }
+    if (res.status_code != 200) {
+        SDL_Log("Failed to fetch schedule (attempt %d)! Error: Server returned %ld", attempt + 1, res.status_code);
+        // honour Retry-After (in seconds) when the server tells us how long to back off
+        if (const auto header = res.header.find("Retry-After"); header != res.header.end()) {
+            long long seconds = 0;
+            const std::string &value = header->second;
+            if (const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), seconds);
+                ec == std::errc() && seconds > 0) {
+                retryDelay = std::max(retryDelay, std::chrono::duration_cast<std::chrono::milliseconds>(
+                                                          std::min<std::chrono::seconds>(
+                                                                  std::chrono::seconds(seconds), MAX_RETRY_AFTER)));
+            }
+        }
+        return false;
+    }
+    return onResponse(res.text);
+}
+
+std::chrono::milliseconds ScheduleFetcher::BackoffDelay(const int attempt) {
+    // capped exponential backoff with "equal jitter": half of the delay is fixed, the other half random,
+    // so many overlays that failed at the same moment don't all retry at the same moment either
+    const auto exponent = std::min(attempt, 20);
+    const auto cap = std::min(options.maxDelay, std::chrono::milliseconds(options.baseDelay.count() << exponent));
+    std::uniform_int_distribution<long long> jitter(0, cap.count() / 2);
+    return std::chrono::milliseconds(cap.count() - cap.count() / 2 + jitter(random));
+}
+
+bool ScheduleFetcher::WaitFor(const std::chrono::milliseconds delay) {
+    std::unique_lock lock(mutex);
+    return !wakeup.wait_for(lock, delay, [this] { return cancelled.load(); });
+}
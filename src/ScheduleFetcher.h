@@ -0,0 +1,46 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+
+struct ScheduleFetcher_Options {
+    std::chrono::milliseconds baseDelay{2000};
+    std::chrono::milliseconds maxDelay{15 * 60 * 1000};
+    std::chrono::milliseconds requestTimeout{15000};
+};
+
+// Fetches the schedule on its own thread and keeps retrying with capped exponential backoff and jitter until
+// the response handler accepts a response. It never gives up on its own, it only stops when cancelled.
+class ScheduleFetcher {
+public:
+    // returns false if the response couldn't be used, which schedules another attempt
+    using ResponseHandler = std::function<bool(const std::string &body)>;
+private:
+    std::string url;
+    ResponseHandler onResponse;
+    ScheduleFetcher_Options options;
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    bool fetchRequested = false;
+    std::atomic<bool> cancelled = false;
+    std::atomic<bool> fetching = false;
+    std::mt19937 random;
+    std::thread worker;
+    void Run();
+    bool TryFetch(int attempt, std::chrono::milliseconds &retryDelay);
+    std::chrono::milliseconds BackoffDelay(int attempt);
+    bool WaitFor(std::chrono::milliseconds delay);
+public:
+    ScheduleFetcher(std::string url, ResponseHandler onResponse, ScheduleFetcher_Options options = {});
+    ~ScheduleFetcher();
+    ScheduleFetcher(const ScheduleFetcher &) = delete;
+    ScheduleFetcher &operator=(const ScheduleFetcher &) = delete;
+    void Fetch();
+    void Cancel();
+    [[nodiscard]] bool IsFetching() const { return this->fetching; }
+};
@@ -0,0 +1,415 @@
+#include "ScheduleHistory.h"
+
+#include <SDL3/SDL_log.h>
+#include <climits>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Both files start with a 16 byte header. Records in the data file are 8 byte aligned and start with an 8 byte
+// record header, offset 0 is the file header so it doubles as "no record" in index entries.
+// Bump HISTORY_VERSION whenever the layout changes, files with another version are left alone.
+
+static constexpr char HISTORY_DATA_MAGIC[4] = {'C', 'S', 'H', 'D'};
+static constexpr char HISTORY_INDEX_MAGIC[4] = {'C', 'S', 'H', 'I'};
+static constexpr uint16_t HISTORY_VERSION = 1;
+
+static constexpr uint16_t HISTORY_RECORD_STRING = 1;
+static constexpr uint16_t HISTORY_RECORD_SCHEDULE = 2;
+
+// a clock that jumped years ahead shouldn't fill the index with empty entries
+static constexpr long long HISTORY_MAX_GAP_DAYS = 10 * 366;
+
+struct HistoryFileHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t reserved;
+    int32_t firstDay;
+    uint32_t reserved2;
+};
+
+struct HistoryRecordHeader {
+    uint16_t type;
+    // number of tracks for schedules, unused for strings
+    uint16_t count;
+    uint32_t size;
+};
+
+struct HistoryIndexEntry {
+    uint32_t scheduleOffset;
+    uint32_t idOffset;
+    uint32_t msgOffset;
+    uint32_t reserved;
+};
+
+struct HistoryEventRecord {
+    uint16_t event;
+    uint16_t startMinute;
+    uint16_t endMinute;
+    uint16_t reserved;
+};
+
+static_assert(MAX_EVENT_CODE <= UINT16_MAX);
+static_assert(sizeof(HistoryFileHeader) == 16);
+static_assert(sizeof(HistoryRecordHeader) == 8);
+static_assert(sizeof(HistoryIndexEntry) == 16);
+static_assert(sizeof(HistoryEventRecord) == 8);
+
+static size_t PadTo8(const size_t size) {
+    return (size + 7) & ~static_cast<size_t>(7);
+}
+
+// the mapped memory has no alignment guarantees beyond the page, so records are always copied out
+template<typename T>
+static bool ReadAt(const std::byte *data, const size_t size, const size_t offset, T &value) {
+    if (offset > size || size - offset < sizeof(T)) {
+        return false;
+    }
+    std::memcpy(&value, data + offset, sizeof(T));
+    return true;
+}
+
+static bool MapFile(const std::string &path, const std::byte *&data, size_t &size, void *&fileHandle,
+                    void *&mappingHandle) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        CloseHandle(file);
+        return false;
+    }
+    const void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    data = static_cast<const std::byte *>(view);
+    size = static_cast<size_t>(fileSize.QuadPart);
+    fileHandle = file;
+    mappingHandle = mapping;
+    return true;
+#else
+    const int file = open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+        return false;
+    }
+    struct stat fileStat{};
+    if (fstat(file, &fileStat) != 0 || fileStat.st_size == 0) {
+        close(file);
+        return false;
+    }
+    void *view = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_SHARED, file, 0);
+    // the mapping keeps the file alive on its own
+    close(file);
+    if (view == MAP_FAILED) {
+        return false;
+    }
+    data = static_cast<const std::byte *>(view);
+    size = static_cast<size_t>(fileStat.st_size);
+    fileHandle = nullptr;
+    mappingHandle = nullptr;
+    return true;
+#endif
+}
+
+static void UnmapFile(const std::byte *&data, size_t &size, void *&fileHandle, void *&mappingHandle) {
+    if (data != nullptr) {
+#ifdef _WIN32
+        UnmapViewOfFile(data);
+        CloseHandle(mappingHandle);
+        CloseHandle(fileHandle);
+#else
+        munmap(const_cast<std::byte *>(data), size);
+#endif
+    }
+    data = nullptr;
+    size = 0;
+    fileHandle = nullptr;
+    mappingHandle = nullptr;
+}
+
+static bool CreateHistoryFile(const std::string &path, const char (&magic)[4]) {
+    HistoryFileHeader header = {};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = HISTORY_VERSION;
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    return file.good();
+}
+
+static bool CheckHeader(const std::byte *data, const size_t size, const char (&magic)[4], HistoryFileHeader &header) {
+    return ReadAt(data, size, 0, header) && std::memcmp(header.magic, magic, sizeof(magic)) == 0 &&
+           header.version == HISTORY_VERSION;
+}
+
+ScheduleHistory::ScheduleHistory(const std::string &basePath) {
+    this->dataFilePath = basePath + ".dat";
+    this->indexFilePath = basePath + ".idx";
+
+    for (const auto &[path, magic]: {std::pair{&dataFilePath, &HISTORY_DATA_MAGIC},
+                                     std::pair{&indexFilePath, &HISTORY_INDEX_MAGIC}}) {
+        if (!std::filesystem::exists(*path) && !CreateHistoryFile(*path, *magic)) {
+            SDL_Log("Couldn't create schedule history %s", path->c_str());
+            return;
+        }
+    }
+    if (!Remap()) {
+        return;
+    }
+    HistoryFileHeader header;
+    if (!CheckHeader(dataMapping.data, dataMapping.size, HISTORY_DATA_MAGIC, header) ||
+        !CheckHeader(indexMapping.data, indexMapping.size, HISTORY_INDEX_MAGIC, header)) {
+        SDL_Log("Ignoring schedule history %s with an unknown format", basePath.c_str());
+        return;
+    }
+    this->valid = true;
+}
+
+ScheduleHistory::~ScheduleHistory() {
+    UnmapFile(dataMapping.data, dataMapping.size, dataMapping.fileHandle, dataMapping.mappingHandle);
+    UnmapFile(indexMapping.data, indexMapping.size, indexMapping.fileHandle, indexMapping.mappingHandle);
+}
+
+bool ScheduleHistory::Remap() {
+    UnmapFile(dataMapping.data, dataMapping.size, dataMapping.fileHandle, dataMapping.mappingHandle);
+    UnmapFile(indexMapping.data, indexMapping.size, indexMapping.fileHandle, indexMapping.mappingHandle);
+    if (!MapFile(dataFilePath, dataMapping.data, dataMapping.size, dataMapping.fileHandle,
+                 dataMapping.mappingHandle) ||
+        !MapFile(indexFilePath, indexMapping.data, indexMapping.size, indexMapping.fileHandle,
+                 indexMapping.mappingHandle)) {
+        SDL_Log("Couldn't map schedule history %s", indexFilePath.c_str());
+        this->valid = false;
+        return false;
+    }
+    return true;
+}
+
+void ScheduleHistory::LoadInternTables() {
+    // only needed once something is appended, lookups never touch these tables
+    internTablesLoaded = true;
+    size_t offset = sizeof(HistoryFileHeader);
+    HistoryRecordHeader record;
+    while (ReadAt(dataMapping.data, dataMapping.size, offset, record)) {
+        const size_t payloadOffset = offset + sizeof(record);
+        if (record.size > dataMapping.size - payloadOffset) {
+            SDL_Log("Schedule history %s ends in a truncated record", dataFilePath.c_str());
+            break;
+        }
+        std::string payload(reinterpret_cast<const char *>(dataMapping.data + payloadOffset), record.size);
+        if (record.type == HISTORY_RECORD_STRING) {
+            stringOffsets.try_emplace(std::move(payload), static_cast<uint32_t>(offset));
+        } else if (record.type == HISTORY_RECORD_SCHEDULE) {
+            payload.insert(0, reinterpret_cast<const char *>(&record.count), sizeof(record.count));
+            scheduleOffsets.try_emplace(std::move(payload), static_cast<uint32_t>(offset));
+        }
+        offset = payloadOffset + PadTo8(record.size);
+    }
+}
+
+uint32_t ScheduleHistory::AppendRecord(const uint16_t type, const uint16_t count, const std::string_view payload) {
+    const size_t offset = dataMapping.size;
+    if (offset + sizeof(HistoryRecordHeader) + PadTo8(payload.size()) > UINT32_MAX) {
+        SDL_Log("Schedule history %s is full", dataFilePath.c_str());
+        return 0;
+    }
+    const HistoryRecordHeader record = {type, count, static_cast<uint32_t>(payload.size())};
+    static constexpr char padding[8] = {};
+    std::ofstream file(dataFilePath, std::ios::binary | std::ios::app);
+    file.write(reinterpret_cast<const char *>(&record), sizeof(record));
+    file.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+    file.write(padding, static_cast<std::streamsize>(PadTo8(payload.size()) - payload.size()));
+    file.close();
+    if (!file.good() || !Remap()) {
+        SDL_Log("Couldn't append to schedule history %s", dataFilePath.c_str());
+        return 0;
+    }
+    return static_cast<uint32_t>(offset);
+}
+
+uint32_t ScheduleHistory::InternString(const std::string &str) {
+    if (const auto it = stringOffsets.find(str); it != stringOffsets.end()) {
+        return it->second;
+    }
+    const uint32_t offset = AppendRecord(HISTORY_RECORD_STRING, 0, str);
+    if (offset != 0) {
+        stringOffsets.emplace(str, offset);
+    }
+    return offset;
+}
+
+uint32_t ScheduleHistory::InternSchedule(const std::vector<std::vector<Sched_Event>> &schedule) {
+    // payload: the event count of every track padded to 8 bytes, followed by all events as fixed-width records
+    std::string payload;
+    for (const auto &track: schedule) {
+        const auto eventCount = static_cast<uint32_t>(track.size());
+        payload.append(reinterpret_cast<const char *>(&eventCount), sizeof(eventCount));
+    }
+    payload.resize(PadTo8(payload.size()));
+    for (const auto &track: schedule) {
+        for (const auto &[event, startS, endS]: track) {
+            const HistoryEventRecord record = {static_cast<uint16_t>(event), static_cast<uint16_t>(startS / 60),
+                                               static_cast<uint16_t>(endS / 60), 0};
+            payload.append(reinterpret_cast<const char *>(&record), sizeof(record));
+        }
+    }
+
+    const auto trackCount = static_cast<uint16_t>(schedule.size());
+    std::string key(reinterpret_cast<const char *>(&trackCount), sizeof(trackCount));
+    key += payload;
+    if (const auto it = scheduleOffsets.find(key); it != scheduleOffsets.end()) {
+        return it->second;
+    }
+    const uint32_t offset = AppendRecord(HISTORY_RECORD_SCHEDULE, trackCount, payload);
+    if (offset != 0) {
+        scheduleOffsets.emplace(std::move(key), offset);
+    }
+    return offset;
+}
+
+bool ScheduleHistory::Append(const long long day, const Schedule_Data &data) {
+    std::lock_guard lock(mutex);
+    if (!valid || day < INT32_MIN || day > INT32_MAX) {
+        return false;
+    }
+    if (!internTablesLoaded) {
+        LoadInternTables();
+    }
+
+    HistoryFileHeader header;
+    if (!ReadAt(indexMapping.data, indexMapping.size, 0, header)) {
+        return false;
+    }
+    const size_t entryCount = (indexMapping.size - sizeof(header)) / sizeof(HistoryIndexEntry);
+    if (entryCount == 0) {
+        header.firstDay = static_cast<int32_t>(day);
+    } else if (day < header.firstDay) {
+        SDL_Log("Not adding day %lld to schedule history, it starts at day %d", day, header.firstDay);
+        return false;
+    } else if (day - header.firstDay - static_cast<long long>(entryCount) > HISTORY_MAX_GAP_DAYS) {
+        SDL_Log("Not adding day %lld to schedule history, it is too far ahead", day);
+        return false;
+    }
+
+    const HistoryIndexEntry entry = {InternSchedule(data.schedule), InternString(data.id), InternString(data.msg), 0};
+    if (entry.scheduleOffset == 0 || entry.idOffset == 0 || entry.msgOffset == 0) {
+        return false;
+    }
+
+    const auto entryIndex = static_cast<size_t>(day - header.firstDay);
+    const size_t entryOffset = sizeof(header) + entryIndex * sizeof(HistoryIndexEntry);
+    if (HistoryIndexEntry existing; entryIndex < entryCount &&
+                                    ReadAt(indexMapping.data, indexMapping.size, entryOffset, existing) &&
+                                    std::memcmp(&existing, &entry, sizeof(entry)) == 0) {
+        return true;
+    }
+
+    {
+        std::fstream file(indexFilePath, std::ios::binary | std::ios::in | std::ios::out);
+        if (entryCount == 0) {
+            file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        }
+        if (entryIndex < entryCount) {
+            // the schedule changed during the day, entries have a fixed size so it is replaced in place
+            file.seekp(static_cast<std::streamoff>(entryOffset));
+        } else {
+            // days without a fetch (weekends, the app not running) get empty entries
+            file.seekp(0, std::ios::end);
+            static constexpr HistoryIndexEntry emptyEntry = {};
+            for (size_t i = entryCount; i < entryIndex; ++i) {
+                file.write(reinterpret_cast<const char *>(&emptyEntry), sizeof(emptyEntry));
+            }
+        }
+        file.write(reinterpret_cast<const char *>(&entry), sizeof(entry));
+        if (!file.good()) {
+            SDL_Log("Couldn't write schedule history %s", indexFilePath.c_str());
+            return false;
+        }
+    }
+    return Remap();
+}
+
+bool ScheduleHistory::ReadString(const uint32_t offset, std::string &str) const {
+    HistoryRecordHeader record;
+    if (!ReadAt(dataMapping.data, dataMapping.size, offset, record) || record.type != HISTORY_RECORD_STRING ||
+        record.size > dataMapping.size - offset - sizeof(record)) {
+        return false;
+    }
+    str.assign(reinterpret_cast<const char *>(dataMapping.data + offset + sizeof(record)), record.size);
+    return true;
+}
+
+bool ScheduleHistory::ReadSchedule(const uint32_t offset, std::vector<std::vector<Sched_Event>> &schedule) const {
+    HistoryRecordHeader record;
+    if (!ReadAt(dataMapping.data, dataMapping.size, offset, record) || record.type != HISTORY_RECORD_SCHEDULE ||
+        record.size > dataMapping.size - offset - sizeof(record)) {
+        return false;
+    }
+    const size_t payloadOffset = offset + sizeof(record);
+    const size_t payloadEnd = payloadOffset + record.size;
+    size_t eventOffset = payloadOffset + PadTo8(record.count * sizeof(uint32_t));
+    // the counts come from the file, a corrupt one must not size anything past what the payload can hold
+    if (eventOffset > payloadEnd) {
+        return false;
+    }
+    schedule.clear();
+    schedule.resize(record.count);
+    for (size_t track = 0; track < record.count; ++track) {
+        uint32_t eventCount;
+        if (!ReadAt(dataMapping.data, payloadEnd, payloadOffset + track * sizeof(uint32_t), eventCount) ||
+            eventCount > (payloadEnd - eventOffset) / sizeof(HistoryEventRecord)) {
+            return false;
+        }
+        schedule[track].reserve(eventCount);
+        for (uint32_t i = 0; i < eventCount; ++i) {
+            HistoryEventRecord event;
+            if (!ReadAt(dataMapping.data, payloadEnd, eventOffset, event)) {
+                return false;
+            }
+            schedule[track].push_back({event.event, event.startMinute * 60, event.endMinute * 60});
+            eventOffset += sizeof(event);
+        }
+    }
+    return true;
+}
+
+bool ScheduleHistory::Lookup(const long long day, Schedule_Data &data) const {
+    std::lock_guard lock(mutex);
+    HistoryFileHeader header;
+    if (!valid || !ReadAt(indexMapping.data, indexMapping.size, 0, header) || day < header.firstDay) {
+        return false;
+    }
+    HistoryIndexEntry entry;
+    const size_t entryCount = (indexMapping.size - sizeof(header)) / sizeof(entry);
+    // checked before multiplying so a far-off day can't wrap the offset back into the index
+    if (static_cast<unsigned long long>(day - header.firstDay) >= entryCount) {
+        return false;
+    }
+    const auto entryIndex = static_cast<size_t>(day - header.firstDay);
+    if (!ReadAt(indexMapping.data, indexMapping.size, sizeof(header) + entryIndex * sizeof(entry), entry) ||
+        entry.scheduleOffset == 0) {
+        return false;
+    }
+    return ReadSchedule(entry.scheduleOffset, data.schedule) && ReadString(entry.idOffset, data.id) &&
+           ReadString(entry.msgOffset, data.msg);
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Schedule.h"
+
+// Append-only history of every day's schedule, kept in two memory-mapped files:
+//  - <path>.dat holds interned records: strings (id/msg) and schedules made of fixed-width event records.
+//    A record is only written the first time its exact contents are seen.
+//  - <path>.idx holds one fixed 16 byte entry per day since the first stored day, pointing into the .dat file.
+// Looking up a day is a single index computation, and a day that repeats an earlier schedule only adds its
+// 16 byte index entry. Both files are little-endian.
+class ScheduleHistory {
+    struct Mapping {
+        const std::byte* data = nullptr;
+        size_t size = 0;
+        void* fileHandle = nullptr;
+        void* mappingHandle = nullptr;
+    };
+
+    std::string dataFilePath;
+    std::string indexFilePath;
+    mutable std::mutex mutex;
+    Mapping dataMapping;
+    Mapping indexMapping;
+    bool valid = false;
+    bool internTablesLoaded = false;
+    std::unordered_map<std::string, uint32_t> stringOffsets;
+    std::unordered_map<std::string, uint32_t> scheduleOffsets;
+
+    bool Remap();
+    void LoadInternTables();
+    uint32_t AppendRecord(uint16_t type, uint16_t count, std::string_view payload);
+    uint32_t InternString(const std::string& str);
+    uint32_t InternSchedule(const std::vector<std::vector<Sched_Event>>& schedule);
+    [[nodiscard]] bool ReadString(uint32_t offset, std::string& str) const;
+    [[nodiscard]] bool ReadSchedule(uint32_t offset, std::vector<std::vector<Sched_Event>>& schedule) const;
+public:
+    explicit ScheduleHistory(const std::string& basePath);
+    ~ScheduleHistory();
+    ScheduleHistory(const ScheduleHistory&) = delete;
+    ScheduleHistory& operator=(const ScheduleHistory&) = delete;
+    bool Append(long long day, const Schedule_Data& data);
+    [[nodiscard]] bool Lookup(long long day, Schedule_Data& data) const;
+};
@@ -0,0 +1,261 @@
+#include "ScheduleParser.h"
+
+#include <format>
+#include <nlohmann/json.hpp>
+#include <vector>
+
+#include "EventNameTable.h"
+#include "Trace.h"
+
+using json = nlohmann::json;
+
+// limits that keep a hostile response from making us allocate without bound
+static constexpr size_t MAX_TRACKS = 16;
+static constexpr size_t MAX_EVENTS_PER_TRACK = 256;
+static constexpr size_t MAX_STRING_LENGTH = 1024;
+
+enum Sched_ParseContext {
+    CONTEXT_ROOT,
+    CONTEXT_DATA,
+    CONTEXT_SCHEDULE,
+    CONTEXT_TRACK,
+    CONTEXT_EVENT,
+    CONTEXT_SKIP
+};
+
+class Sched_ParseHandler : public json::json_sax_t {
+    Schedule_Response &response;
+    Sched_ParseError &error;
+    std::vector<Sched_ParseContext> contexts;
+    std::string currentKey;
+    int skipDepth = 0;
+    bool hasStatus = false;
+    bool hasData = false;
+    bool hasId = false;
+    bool hasMsg = false;
+    bool hasSchedule = false;
+    std::array<long long, 5> eventFields{};
+    size_t eventFieldCount = 0;
+
+    bool Fail(const Sched_ParseErrorCode code, std::string message) {
+        error.code = code;
+        error.message = std::move(message);
+        return false;
+    }
+
+    [[nodiscard]] std::string EventPath() const {
+        const auto &tracks = response.data.schedule;
+        return std::format("data.schedule[{}][{}]", tracks.size() - 1, tracks.back().size());
+    }
+
+    bool StartContainer(const bool isArray) {
+        if (skipDepth > 0) {
+            skipDepth++;
+            return true;
+        }
+        const Sched_ParseContext context = contexts.empty() ? CONTEXT_SKIP : contexts.back();
+        if (contexts.empty()) {
+            if (isArray) {
+                return Fail(SCHED_PARSE_WRONG_TYPE, "response must be an object");
+            }
+            contexts.push_back(CONTEXT_ROOT);
+            return true;
+        }
+        switch (context) {
+            case CONTEXT_ROOT:
+                if (currentKey == "data") {
+                    if (isArray) return Fail(SCHED_PARSE_WRONG_TYPE, "data must be an object");
+                    hasData = true;
+                    contexts.push_back(CONTEXT_DATA);
+                    return true;
+                }
+                break;
+            case CONTEXT_DATA:
+                if (currentKey == "schedule") {
+                    if (!isArray) return Fail(SCHED_PARSE_WRONG_TYPE, "data.schedule must be an array");
+                    hasSchedule = true;
+                    contexts.push_back(CONTEXT_SCHEDULE);
+                    return true;
+                }
+                break;
+            case CONTEXT_SCHEDULE:
+                if (!isArray) return Fail(SCHED_PARSE_WRONG_TYPE, "data.schedule tracks must be arrays");
+                if (response.data.schedule.size() >= MAX_TRACKS) {
+                    return Fail(SCHED_PARSE_TOO_LARGE, std::format("more than {} schedule tracks", MAX_TRACKS));
+                }
+                response.data.schedule.emplace_back();
+                contexts.push_back(CONTEXT_TRACK);
+                return true;
+            case CONTEXT_TRACK:
+                if (!isArray) return Fail(SCHED_PARSE_WRONG_TYPE, EventPath() + " must be an array");
+                if (response.data.schedule.back().size() >= MAX_EVENTS_PER_TRACK) {
+                    return Fail(SCHED_PARSE_TOO_LARGE, std::format("more than {} events in a track", MAX_EVENTS_PER_TRACK));
+                }
+                eventFieldCount = 0;
+                contexts.push_back(CONTEXT_EVENT);
+                return true;
+            case CONTEXT_EVENT:
+                return Fail(SCHED_PARSE_WRONG_TYPE, EventPath() + " must only contain integers");
+            default:
+                break;
+        }
+        // anything we don't know about is skipped without storing it
+        skipDepth = 1;
+        return true;
+    }
+
+    bool EndContainer() {
+        if (skipDepth > 0) {
+            skipDepth--;
+            return true;
+        }
+        if (contexts.back() == CONTEXT_EVENT && !FinishEvent()) {
+            return false;
+        }
+        contexts.pop_back();
+        return true;
+    }
+
+    bool FinishEvent() {
+        if (eventFieldCount != eventFields.size()) {
+            return Fail(SCHED_PARSE_MISSING_FIELD, EventPath() + " must have 5 fields");
+        }
+        const auto [startH, startM, event, endH, endM] = eventFields;
+        if (startH < 0 || startH > 24 || endH < 0 || endH > 24 || startM < 0 || startM > 59 || endM < 0 ||
+            endM > 59) {
+            return Fail(SCHED_PARSE_OUT_OF_RANGE, EventPath() + " has an invalid time");
+        }
+        if (event < 0 || event > MAX_EVENT_CODE) {
+            return Fail(SCHED_PARSE_OUT_OF_RANGE, EventPath() + " has an invalid event code");
+        }
+        const int startS = static_cast<int>(startH * 60 * 60 + startM * 60);
+        const int endS = static_cast<int>(endH * 60 * 60 + endM * 60);
+        if (endS < startS || endS > 24 * 60 * 60) {
+            return Fail(SCHED_PARSE_OUT_OF_RANGE, EventPath() + " ends before it starts");
+        }
+        response.data.schedule.back().push_back({static_cast<int>(event), startS, endS});
+        return true;
+    }
+
+    bool Integer(const long long value) {
+        if (skipDepth > 0 || contexts.empty()) {
+            return true;
+        }
+        if (contexts.back() == CONTEXT_EVENT) {
+            if (eventFieldCount >= eventFields.size()) {
+                return Fail(SCHED_PARSE_TOO_LARGE, EventPath() + " has more than 5 fields");
+            }
+            eventFields[eventFieldCount++] = value;
+            return true;
+        }
+        return Scalar("an integer");
+    }
+
+    bool Scalar(const char *type) {
+        if (skipDepth > 0 || contexts.empty()) {
+            return true;
+        }
+        switch (contexts.back()) {
+            case CONTEXT_ROOT:
+                if (currentKey == "status" || currentKey == "data") {
+                    return Fail(SCHED_PARSE_WRONG_TYPE, std::format("{} must not be {}", currentKey, type));
+                }
+                return true;
+            case CONTEXT_DATA:
+                if (currentKey == "id" || currentKey == "msg" || currentKey == "schedule") {
+                    return Fail(SCHED_PARSE_WRONG_TYPE, std::format("data.{} must not be {}", currentKey, type));
+                }
+                return true;
+            case CONTEXT_SCHEDULE:
+                return Fail(SCHED_PARSE_WRONG_TYPE, "data.schedule tracks must be arrays");
+            case CONTEXT_TRACK:
+                return Fail(SCHED_PARSE_WRONG_TYPE, EventPath() + " must be an array");
+            case CONTEXT_EVENT:
+                return Fail(SCHED_PARSE_WRONG_TYPE, EventPath() + std::format(" must not contain {}", type));
+            default:
+                return true;
+        }
+    }
+
+public:
+    Sched_ParseHandler(Schedule_Response &response, Sched_ParseError &error) : response(response), error(error) {
+        contexts.reserve(8);
+    }
+
+    bool null() override { return Scalar("null"); }
+    bool boolean(bool) override { return Scalar("a boolean"); }
+    bool number_integer(const number_integer_t value) override { return Integer(value); }
+    bool number_unsigned(const number_unsigned_t value) override {
+        return Integer(value > static_cast<number_unsigned_t>(INT32_MAX) ? INT32_MAX : static_cast<long long>(value));
+    }
+    bool number_float(number_float_t, const string_t &) override { return Scalar("a decimal number"); }
+    bool binary(binary_t &) override { return Scalar("binary data"); }
+
+    bool string(string_t &value) override {
+        if (skipDepth > 0 || contexts.empty()) {
+            return true;
+        }
+        std::string *target = nullptr;
+        if (contexts.back() == CONTEXT_ROOT && currentKey == "status") {
+            target = &response.status;
+            hasStatus = true;
+        } else if (contexts.back() == CONTEXT_DATA && currentKey == "id") {
+            target = &response.data.id;
+            hasId = true;
+        } else if (contexts.back() == CONTEXT_DATA && currentKey == "msg") {
+            target = &response.data.msg;
+            hasMsg = true;
+        }
+        if (target == nullptr) {
+            return Scalar("a string");
+        }
+        if (value.size() > MAX_STRING_LENGTH) {
+            return Fail(SCHED_PARSE_TOO_LARGE, currentKey + " is too long");
+        }
+        *target = std::move(value);
+        return true;
+    }
+
+    bool start_object(std::size_t) override { return StartContainer(false); }
+    bool end_object() override { return EndContainer(); }
+    bool start_array(std::size_t) override { return StartContainer(true); }
+    bool end_array() override { return EndContainer(); }
+
+    bool key(string_t &value) override {
+        if (skipDepth == 0) {
+            currentKey = std::move(value);
+        }
+        return true;
+    }
+
+    bool parse_error(const std::size_t position, const std::string &, const json::exception &ex) override {
+        error.offset = position;
+        return Fail(SCHED_PARSE_SYNTAX, ex.what());
+    }
+
+    bool Finish() {
+        if (!hasStatus) return Fail(SCHED_PARSE_MISSING_FIELD, "missing status");
+        // an error response only needs to tell us its status
+        if (response.status != "OK") return true;
+        if (!hasData) return Fail(SCHED_PARSE_MISSING_FIELD, "missing data");
+        if (!hasId) return Fail(SCHED_PARSE_MISSING_FIELD, "missing data.id");
+        if (!hasMsg) return Fail(SCHED_PARSE_MISSING_FIELD, "missing data.msg");
+        if (!hasSchedule) return Fail(SCHED_PARSE_MISSING_FIELD, "missing data.schedule");
+        return true;
+    }
+};
+
+bool Sched_ParseResponse(const std::string_view text, Schedule_Response &response, Sched_ParseError &error) {
+    TRACE_SCOPE("Schedule parse");
+    response = {};
+    error = {};
+    Sched_ParseHandler handler(response, error);
+    if (!json::sax_parse(text, &handler) || error.code != SCHED_PARSE_OK) {
+        if (error.code == SCHED_PARSE_OK) {
+            error.code = SCHED_PARSE_SYNTAX;
+            error.message = "invalid JSON";
+        }
+        return false;
+    }
+    return handler.Finish();
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <string>
+#include <string_view>
+
+#include "Schedule.h"
+
+enum Sched_ParseErrorCode {
+    SCHED_PARSE_OK = 0,
+    SCHED_PARSE_SYNTAX = 1,
+    SCHED_PARSE_MISSING_FIELD = 2,
+    SCHED_PARSE_WRONG_TYPE = 3,
+    SCHED_PARSE_OUT_OF_RANGE = 4,
+    SCHED_PARSE_TOO_LARGE = 5
+};
+
+struct Sched_ParseError {
+    Sched_ParseErrorCode code = SCHED_PARSE_OK;
+    size_t offset = 0;
+    std::string message;
+};
+
+struct Schedule_Response {
+    std::string status;
+    Schedule_Data data;
+};
+
+// Parses a /today response straight into Schedule_Data without building a JSON document. Never throws, a
+// malformed or hostile response is reported through error instead.
+bool Sched_ParseResponse(std::string_view text, Schedule_Response &response, Sched_ParseError &error);
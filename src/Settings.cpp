@@ -2,41 +2,102 @@
 
 #include <SDL3/SDL_log.h>
 #include <SDL3/SDL_render.h>
+#include <SDL3/SDL_timer.h>
+#include <algorithm>
+#include <cstring>
+#include <format>
 #include <fstream>
+#include <iterator>
 #include <nlohmann/json.hpp>
+#include <tuple>
 #include <utility>
 
 static const SDL_Color selectedColor = {255, 255, 255, 255};
 static const SDL_Color unSelectedColor = {150, 150, 150, 255};
 static const SDL_Color hoverColor = {190, 190, 190, 255};
-
-Settings::Settings(const std::string &saveFilePath) {
+// pixel sizes of the window title and of every other row at a display scale of 1
+static constexpr float TITLE_FONT_SIZE = 32;
+static constexpr float ROW_FONT_SIZE = 16;
+// pixels scrolled per mouse wheel notch at a display scale of 1
+static constexpr float SCROLL_STEP = 40;
+// window size at a content scale of 1
+static constexpr int SETTINGS_WINDOW_WIDTH = 400;
+static constexpr int SETTINGS_WINDOW_HEIGHT = 800;
+// changes made within this time of each other end up in a single write
+static constexpr Uint64 SAVE_DEBOUNCE_NS = SDL_MS_TO_NS(500);
+
+// the debounce happens here on the main thread, so the writer only has to get the content on disk
+Settings::Settings(const std::string &saveFilePath) : writer(saveFilePath, std::chrono::milliseconds(0)) {
     this->saveFilePath = saveFilePath;
-    Load();
-    Save();
+    // only write the file back if it is missing, invalid or lacks some of the settings
+    if (Load()) {
+        writer.MarkWritten(Serialize());
+    } else {
+        writer.Write(Serialize());
+    }
+    RebuildEventNames();
 }
 
 void Settings::Save() {
+    // typing in a text box calls this for every key, so it must stay this cheap
+    saveAtNS = SDL_GetTicksNS() + SAVE_DEBOUNCE_NS;
+}
+
+void Settings::SaveIfDue() {
+    if (saveAtNS == 0 || SDL_GetTicksNS() < saveAtNS) {
+        return;
+    }
+    saveAtNS = 0;
+    if (eventNamesDirty) {
+        RebuildEventNames();
+    }
+    writer.Write(Serialize());
+}
+
+void Settings::Flush() {
+    if (saveAtNS != 0) {
+        saveAtNS = SDL_GetTicksNS();
+        SaveIfDue();
+    }
+    writer.Flush();
+}
+
+std::string Settings::Serialize() const {
     auto settingsJson = nlohmann::json();
 
     settingsJson["theme"] = this->theme;
     settingsJson["showProgressBar"] = this->showProgressBar;
     settingsJson["showSeconds"] = this->showSeconds;
     settingsJson["showPercentage"] = this->showPercentage;
+    settingsJson["largeText"] = this->largeText;
+    settingsJson["showTraceHud"] = this->showTraceHud;
     settingsJson["fontLocation"] = this->fontLocation;
+    settingsJson["timeZone"] = this->timeZone;
     settingsJson["defaultLunch"] = this->defaultLunch;
     const nlohmann::json periodAliases(this->periodAliases);
     settingsJson["periodAliases"] = periodAliases;
 
-    std::ofstream jsonFile(saveFilePath);
-    jsonFile << std::setw(4) << settingsJson;
+    return settingsJson.dump(4);
 }
 
-void Settings::Load() {
-    std::ifstream jsonFile(saveFilePath);
-    if (!std::filesystem::exists(saveFilePath)) return;
+static bool ReadSettingsFile(const std::string &path, std::string &text) {
+    if (!std::filesystem::exists(path)) return false;
+    std::ifstream jsonFile(path, std::ios::binary);
+    text.assign(std::istreambuf_iterator<char>(jsonFile), std::istreambuf_iterator<char>());
+    return jsonFile.good() || jsonFile.eof();
+}
 
-    auto settingsJson = nlohmann::json::parse(jsonFile);
+bool Settings::Load() {
+    std::string text;
+    return ReadSettingsFile(saveFilePath, text) && LoadFrom(text) == SETTINGS_LOAD_OK;
+}
+
+Settings_LoadResult Settings::LoadFrom(const std::string &text) {
+    auto settingsJson = nlohmann::json::parse(text, nullptr, false);
+    if (settingsJson.is_discarded() || !settingsJson.is_object()) {
+        SDL_Log("Ignoring invalid settings file %s", saveFilePath.c_str());
+        return SETTINGS_LOAD_INVALID;
+    }
 
     if (settingsJson["theme"].is_number_integer()) {
         this->theme = settingsJson["theme"];
@@ -50,38 +111,155 @@ void Settings::Load() {
     if (settingsJson["showPercentage"].is_boolean()) {
         this->showPercentage = settingsJson["showPercentage"];
     }
+    if (settingsJson["largeText"].is_boolean()) {
+        this->largeText = settingsJson["largeText"];
+    }
+    if (settingsJson["showTraceHud"].is_boolean()) {
+        this->showTraceHud = settingsJson["showTraceHud"];
+    }
     if (settingsJson["fontLocation"].is_string()) {
         if (std::filesystem::exists(settingsJson["fontLocation"])) {
             this->fontLocation = settingsJson["fontLocation"];
         }
     }
+    if (settingsJson["timeZone"].is_string()) {
+        this->timeZone = settingsJson["timeZone"];
+    }
     if (settingsJson["defaultLunch"].is_number_integer()) {
-        this->defaultLunch = settingsJson["defaultLunch"];
+        this->defaultLunch = std::max(0, settingsJson["defaultLunch"].get<int>());
     }
-    this->currentLunch = this->defaultLunch;
+    this->currentLunch = std::min(this->defaultLunch, trackCount - 1);
     if (settingsJson["periodAliases"].is_object()) {
-        for (const auto &key: this->periodAliases | std::views::keys) {
-            if (settingsJson["periodAliases"][key].is_string()) {
-                this->periodAliases[key] = settingsJson["periodAliases"][key];
+        // aliases for codes without a built-in name, like "Event 42", are kept as well
+        for (const auto &[key, value]: settingsJson["periodAliases"].items()) {
+            if (value.is_string()) {
+                this->periodAliases[key] = value;
+            }
+        }
+    }
+    // missing keys were added as null above, so this also catches files from older versions
+    return settingsJson.dump(4) == Serialize() ? SETTINGS_LOAD_OK : SETTINGS_LOAD_INCOMPLETE;
+}
+
+unsigned Settings::Reload() {
+    std::string text;
+    // our own saves come back through the watcher as well, they never change anything
+    if (!writer.ReadExternalChange(text)) {
+        return SETTINGS_CHANGE_NONE;
+    }
+    const Theme oldTheme = this->theme;
+    const bool oldShowProgressBar = this->showProgressBar;
+    const bool oldShowSeconds = this->showSeconds;
+    const bool oldShowPercentage = this->showPercentage;
+    const bool oldLargeText = this->largeText;
+    const bool oldShowTraceHud = this->showTraceHud;
+    const std::string oldFontLocation = this->fontLocation;
+    const std::string oldTimeZone = this->timeZone;
+    const int oldDefaultLunch = this->defaultLunch;
+    const int oldCurrentLunch = this->currentLunch;
+    const auto oldPeriodAliases = this->periodAliases;
+    // a half written or broken file keeps the current settings, nothing above has been touched yet
+    if (LoadFrom(text) == SETTINGS_LOAD_INVALID) {
+        return SETTINGS_CHANGE_NONE;
+    }
+    writer.MarkWritten(text);
+
+    unsigned changes = SETTINGS_CHANGE_NONE;
+    if (this->theme != oldTheme || this->showProgressBar != oldShowProgressBar ||
+        this->showSeconds != oldShowSeconds || this->showPercentage != oldShowPercentage ||
+        this->largeText != oldLargeText || this->showTraceHud != oldShowTraceHud) {
+        changes |= SETTINGS_CHANGE_DISPLAY;
+    }
+    if (this->fontLocation != oldFontLocation) {
+        changes |= SETTINGS_CHANGE_FONT;
+    }
+    if (this->timeZone != oldTimeZone) {
+        changes |= SETTINGS_CHANGE_TIME_ZONE;
+    }
+    if (this->defaultLunch != oldDefaultLunch) {
+        changes |= SETTINGS_CHANGE_LUNCH;
+    } else {
+        // a lunch picked for today only stays until the default itself changes
+        this->currentLunch = oldCurrentLunch;
+    }
+    bool aliasAdded = false;
+    for (const auto &[name, alias]: this->periodAliases) {
+        if (const auto it = oldPeriodAliases.find(name); it == oldPeriodAliases.end() || it->second != alias) {
+            changes |= SETTINGS_CHANGE_ALIASES;
+            aliasAdded |= it == oldPeriodAliases.end();
+            // only the rows whose alias changed lose their texture
+            if (this->isOpen) {
+                textManager->DestroyText("settings.periodAliases." + name + ".value");
             }
         }
     }
+    if (changes & SETTINGS_CHANGE_ALIASES) {
+        RebuildEventNames();
+    }
+    // an alias for a new event code needs its own row
+    if (this->isOpen && aliasAdded) {
+        SelectTextBox(-1);
+        hoveredWidget = -1;
+        BuildWidgets();
+    }
+
+    if (this->isOpen && changes != SETTINGS_CHANGE_NONE) {
+        if (selectedTextBox >= 0) {
+            textCursor = std::min(textCursor, widgets[selectedTextBox].textValue->size());
+        }
+        needsRedraw = true;
+    }
+    return changes;
+}
+
+void Settings::OnFontClosed(TTF_Font *font) const {
+    if (this->isOpen) {
+        textManager->DestroyFontTexts(font);
+    }
+}
+
+void Settings::ApplyFontLocation() {
+    fontCache->SetPath(this->fontLocation);
+    if (this->isOpen) {
+        LayoutWidgets();
+        needsRedraw = true;
+    }
+}
+
+void Settings::SetTrackCount(int count) {
+    count = std::max(count, 1);
+    if (count == trackCount) {
+        return;
+    }
+    trackCount = count;
+    currentLunch = std::min(defaultLunch, trackCount - 1);
+    if (this->isOpen) {
+        SelectTextBox(-1);
+        hoveredWidget = -1;
+        BuildWidgets();
+        needsRedraw = true;
+    }
 }
 
 void Settings::OpenSettings() {
     if (!this->isOpen) {
         isOpen = true;
-        if (!SDL_CreateWindowAndRenderer("Crooms Bell Schedule Settings", 400, 800, SDL_WINDOW_HIGH_PIXEL_DENSITY,
+        needsRedraw = true;
+        if (!SDL_CreateWindowAndRenderer("Crooms Bell Schedule Settings", SETTINGS_WINDOW_WIDTH,
+                                         SETTINGS_WINDOW_HEIGHT, SDL_WINDOW_HIGH_PIXEL_DENSITY | SDL_WINDOW_RESIZABLE,
                                          &window, &renderer)) {
             SDL_Log("Couldn't create window/renderer: %s", SDL_GetError());
                                          }
+        // window coordinates only grow with the part of the display scale that isn't already in the pixel density
+        const float contentScale = SDL_GetWindowDisplayScale(window) / SDL_GetWindowPixelDensity(window);
+        SDL_SetWindowSize(window, static_cast<int>(SETTINGS_WINDOW_WIDTH * contentScale),
+                          static_cast<int>(SETTINGS_WINDOW_HEIGHT * contentScale));
         SDL_RaiseWindow(window);
         textManager = new TextManager(renderer);
-        currentFont = TTF_OpenFont(this->fontLocation.c_str(), 32);
-        if (currentFont == nullptr) {
-            SDL_Log("TTF_OpenFont() Error: %s", SDL_GetError());
+        if (!HoldFonts()) {
             exit(1);
         }
+        BuildWidgets();
     }
 }
 
@@ -89,203 +267,411 @@ void Settings::CloseSettings() {
     if (this->isOpen) {
         isOpen = false;
         hasFocus = false;
+        SelectTextBox(-1);
 
+        // the text manager's textures belong to the renderer, so release them first
+        delete textManager;
+        textManager = nullptr;
+        ReleaseFonts();
         SDL_DestroyRenderer(renderer);
         SDL_DestroyWindow(window);
-        TTF_CloseFont(currentFont);
-        delete textManager;
 
         renderer = nullptr;
         window = nullptr;
-        currentFont = nullptr;
-        textManager = nullptr;
-        currentHovered = "";
+        widgets.clear();
+        hoveredWidget = -1;
+        traceHudLines = 0;
+        scrollY = 0;
         mouseX = 0;
         mouseY = 0;
 
         Save();
-        Load();
     }
 }
 
+bool Settings::HoldFonts() {
+    uiScale = SDL_GetWindowDisplayScale(window);
+    if (uiScale <= 0) {
+        uiScale = 1;
+    }
+    const float titleSize = TITLE_FONT_SIZE * uiScale;
+    const float rowSize = ROW_FONT_SIZE * uiScale;
+    if (titleSize != heldTitleSize || rowSize != heldRowSize) {
+        // the sizes the overlay uses too are shared with it, acquiring first keeps a size both scales use open
+        fontCache->Acquire(titleSize);
+        fontCache->Acquire(rowSize);
+        ReleaseFonts();
+        heldTitleSize = titleSize;
+        heldRowSize = rowSize;
+    }
+    return fontCache->Get(heldRowSize) != nullptr;
+}
+
+void Settings::ReleaseFonts() {
+    if (heldTitleSize > 0) {
+        fontCache->Release(heldTitleSize);
+        fontCache->Release(heldRowSize);
+    }
+    heldTitleSize = 0;
+    heldRowSize = 0;
+}
+
 void Settings::RaiseWindow() const {
     if (window != nullptr) {
         SDL_RaiseWindow(window);
     }
 }
 
-bool Settings::isHovering(std::string settingsValue, float x, float y, float width, float height) {
-    bool result = mouseX >= x && mouseX <= x + width && mouseY >= y && mouseY <= y + height;
-    if (result) {
-        this->currentHovered = std::move(settingsValue);
+void Settings::BuildWidgets() {
+    widgets.clear();
+    // row metrics in pixels at the window's display scale
+    const float margin = 10 * uiScale;
+    const float indent = 20 * uiScale;
+    const float gap = 5 * uiScale;
+    widgets.push_back({.kind = SETTINGS_WIDGET_LABEL, .x = margin, .fontSize = heldTitleSize, .spacingAfter = 2 * gap,
+                       .label = "Settings", .labelKey = "settings.title"});
+
+    widgets.push_back({.kind = SETTINGS_WIDGET_LABEL, .x = margin, .fontSize = heldRowSize, .spacingAfter = gap,
+                       .label = "Theme: ", .labelKey = "settings.theme.title"});
+    for (const auto &[label, value]: {std::pair{"Light", LIGHT}, std::pair{"Dark", DARK}}) {
+        widgets.push_back({.kind = SETTINGS_WIDGET_OPTION, .x = indent, .fontSize = heldRowSize, .spacingAfter = 0,
+                           .label = label, .labelKey = std::string("settings.theme.value.") + label,
+                           .isSelected = [this, value] { return this->theme == value; },
+                           .select = [this, value] { this->theme = value; }});
+    }
+    widgets.back().spacingAfter = gap;
+
+    widgets.push_back({.kind = SETTINGS_WIDGET_LABEL, .x = margin, .fontSize = heldRowSize, .spacingAfter = gap,
+                       .label = "Lunch: ", .labelKey = "settings.lunch.title"});
+    // one option per track of the schedule on screen, Lunch A, Lunch B, ...
+    for (int track = 0; track < trackCount; ++track) {
+        const std::string label = track < 26 ? std::format("Lunch {:c}", static_cast<char>('A' + track))
+                                             : std::format("Lunch {}", track + 1);
+        widgets.push_back({.kind = SETTINGS_WIDGET_OPTION, .x = indent, .fontSize = heldRowSize, .spacingAfter = 0,
+                           .label = label, .labelKey = "settings.lunch.value." + label,
+                           .isSelected = [this, track] { return this->currentLunch == track; },
+                           .select = [this, track] {
+                               this->defaultLunch = track;
+                               this->currentLunch = this->defaultLunch;
+                           }});
+    }
+    widgets.back().spacingAfter = gap;
+
+    for (const auto &[label, key, value]: {std::tuple{"Show Progress Bar", "showProgressBar", &this->showProgressBar},
+                                           std::tuple{"Show Percentage", "showPercentage", &this->showPercentage},
+                                           std::tuple{"Show Seconds", "showSeconds", &this->showSeconds},
+                                           std::tuple{"Large Text", "largeText", &this->largeText},
+                                           std::tuple{"Show Trace HUD", "showTraceHud", &this->showTraceHud}}) {
+        widgets.push_back({.kind = SETTINGS_WIDGET_TOGGLE, .x = margin, .fontSize = heldRowSize, .spacingAfter = gap,
+                           .label = std::string(label) + ": ", .labelKey = std::string("settings.") + key + ".title",
+                           .valueKey = std::string("settings.") + key + ".value", .toggleValue = value});
     }
-    return result;
-}
 
-void Settings::drawBooleanSetting(bool settingValue, const std::string& settingName, const std::string& settingID) {
-    SDL_FRect settingTitle = textManager->RenderText(currentFont, settingID + ".title",
-        settingName + ": ", 10 + currentX, currentY, {255, 255, 255, 255}, 0.5f);
-    bool showPercentageHovering = isHovering(settingID + ".value", 20 + currentX, currentY, 380,
-                         settingTitle.h);
-    textManager->RenderText(currentFont, settingID + ".value",
-        settingValue ? "On" : "Off", settingTitle.w + settingTitle.x,
-        currentY, settingValue ? selectedColor : showPercentageHovering? hoverColor: unSelectedColor, 0.5f);
-    currentY += settingTitle.h + 5;
+    widgets.push_back({.kind = SETTINGS_WIDGET_TEXT, .x = margin, .fontSize = heldRowSize, .spacingAfter = gap,
+                       .label = "Font Location: ", .labelKey = "settings.fontLocation.title",
+                       .valueKey = "settings.fontLocation.value", .textValue = &this->fontLocation});
+
+    widgets.push_back({.kind = SETTINGS_WIDGET_LABEL, .x = margin, .fontSize = heldRowSize, .spacingAfter = gap,
+                       .label = "Period Aliases: ", .labelKey = "settings.periodAliases.title"});
+    // map nodes never move, so the widgets can point straight at the values
+    for (auto &[name, alias]: this->periodAliases) {
+        widgets.push_back({.kind = SETTINGS_WIDGET_TEXT, .x = indent, .fontSize = heldRowSize, .spacingAfter = gap,
+                           .label = name + ": ", .labelKey = "settings.periodAliases." + name + ".title",
+                           .valueKey = "settings.periodAliases." + name + ".value", .textValue = &alias});
+    }
+    LayoutWidgets();
 }
 
-void Settings::drawOptionsSetting(const std::string& settingName, const std::string& settingID, const std::string& currentValue,
-                                  std::string* values, int valuesLength) {
-    SDL_FRect settingTitle = textManager->RenderText(currentFont, settingID + ".title",
-        settingName + ": ", 10 + currentX, currentY, {255, 255, 255, 255}, 0.5f);
-    currentY += settingTitle.h + 5;
-    for (int i = 0; i < valuesLength; ++i) {
-        std::string valueID = settingID;
-        valueID += ".value." + values[i];
-        SDL_FRect valueOption = textManager->RenderText(currentFont, valueID,
-        values[i], 20 + currentX, currentY,
-        currentValue == values[i] ? selectedColor:
-        isHovering(valueID, 20 + currentX, currentY, 380,
-                         settingTitle.h)
-                    ? hoverColor
-                    : unSelectedColor, 0.5f);
-        currentY += valueOption.h;
+void Settings::LayoutWidgets() {
+    // every row is one line of text, so its height is known without rendering it
+    float y = 5 * uiScale;
+    for (Settings_Widget &widget: widgets) {
+        widget.font = fontCache->Get(widget.fontSize);
+        widget.y = y;
+        widget.height = widget.font != nullptr ? static_cast<float>(TTF_GetFontHeight(widget.font)) : widget.fontSize;
+        y += widget.height + widget.spacingAfter;
     }
-    currentY += 5;
+    contentHeight = y;
 }
 
-std::string Settings::getTextBoxSetting(const std::string &textBoxID) {
-    if (textBoxID == "settings.fontLocation.value") {
-        return this->fontLocation;
+void Settings::ScrollBy(const float delta) {
+    // rows are laid out in pixels, so the viewport is the renderer's output and not the window's size in points
+    int viewportHeight = 0;
+    SDL_GetCurrentRenderOutputSize(renderer, nullptr, &viewportHeight);
+    const float maxScrollY = std::max(0.0f, contentHeight - static_cast<float>(viewportHeight));
+    const float newScrollY = std::clamp(scrollY + delta, 0.0f, maxScrollY);
+    if (newScrollY != scrollY) {
+        scrollY = newScrollY;
+        needsRedraw = true;
+        UpdateHover();
     }
-    for (auto &[key, value] : this->periodAliases) {
-        if (textBoxID == "settings.periodAliases." + key + ".value") {
-            return value;
+}
+
+void Settings::UpdateHover() {
+    int hovered = -1;
+    const float contentY = mouseY + scrollY;
+    for (int i = 0; i < static_cast<int>(widgets.size()); ++i) {
+        const SDL_FRect &rect = widgets[i].rect;
+        if (widgets[i].visible && widgets[i].kind != SETTINGS_WIDGET_LABEL && mouseX >= rect.x &&
+            mouseX <= rect.x + rect.w && contentY >= rect.y && contentY <= rect.y + rect.h) {
+            hovered = i;
         }
     }
-    return "";
+    if (hovered != this->hoveredWidget) {
+        this->hoveredWidget = hovered;
+        this->needsRedraw = true;
+    }
 }
 
-
-void Settings::changeTextBoxSetting(const std::string &textBoxID, const std::string& str) {
-    if (textBoxID == "settings.fontLocation.value") {
-        this->fontLocation = str;
-    }
-    for (auto &[key, value] : this->periodAliases) {
-        if (textBoxID == "settings.periodAliases." + key + ".value") {
-            this->periodAliases[key] = str;
+void Settings::DrawWidget(Settings_Widget &widget, const float y, const float viewportWidth) {
+    const int index = static_cast<int>(&widget - widgets.data());
+    const bool hovered = index == hoveredWidget;
+    switch (widget.kind) {
+        case SETTINGS_WIDGET_LABEL: {
+            textManager->RenderText(widget.font, widget.labelKey, widget.label, widget.x, y, {255, 255, 255, 255}, 1);
+            return;
+        }
+        case SETTINGS_WIDGET_OPTION: {
+            const SDL_Color color = widget.isSelected() ? selectedColor : hovered ? hoverColor : unSelectedColor;
+            const SDL_FRect option = textManager->RenderText(widget.font, widget.labelKey, widget.label, widget.x, y,
+                                                             color, 1);
+            widget.rect = {widget.x, widget.y, viewportWidth - 20 * uiScale, option.h};
+            return;
+        }
+        case SETTINGS_WIDGET_TOGGLE: {
+            static const std::string on = "On";
+            static const std::string off = "Off";
+            const SDL_FRect title = textManager->RenderText(widget.font, widget.labelKey, widget.label, widget.x, y,
+                                                            {255, 255, 255, 255}, 1);
+            const bool value = *widget.toggleValue;
+            textManager->RenderText(widget.font, widget.valueKey, value ? on : off, title.x + title.w, y,
+                                    value ? selectedColor : hovered ? hoverColor : unSelectedColor, 1);
+            widget.rect = {widget.x + 10 * uiScale, widget.y, viewportWidth - 20 * uiScale, title.h};
+            return;
+        }
+        case SETTINGS_WIDGET_TEXT: {
+            const bool selected = index == selectedTextBox;
+            const SDL_FRect title = textManager->RenderText(widget.font, widget.labelKey, widget.label, widget.x, y,
+                                                            {255, 255, 255, 255}, 1);
+            // rows stretch with the window, the scrollbar keeps the last 10 points
+            const SDL_FRect underline = {title.x + title.w, y + title.h,
+                                         viewportWidth - 10 * uiScale - title.x - title.w, 2 * uiScale};
+            const SDL_Color color = selected ? selectedColor : hovered ? hoverColor : unSelectedColor;
+            SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
+            SDL_RenderFillRect(renderer, &underline);
+            textManager->RenderText(widget.font, widget.valueKey, *widget.textValue, underline.x, y,
+                                    {255, 255, 255, 255}, 1);
+            if (selected) {
+                int cursorX = 0;
+                if (textCursor > 0) {
+                    TTF_GetStringSize(widget.font, widget.textValue->c_str(), textCursor, &cursorX, nullptr);
+                }
+                const SDL_FRect cursor = {underline.x + static_cast<float>(cursorX) + uiScale, y, 2 * uiScale, title.h};
+                SDL_RenderFillRect(renderer, &cursor);
+            }
+            widget.rect = {underline.x, widget.y, underline.w, title.h};
+            return;
         }
     }
 }
 
-
-void Settings::drawTextSetting(const std::string& settingValue, const std::string& settingName, const std::string& settingID) {
-    SDL_FRect settingTitle = textManager->RenderText(currentFont, settingID + ".title",
-        settingName + ": ", 10 + currentX, currentY, {255, 255, 255, 255}, 0.5f);
-
-    SDL_FRect textBoxUnderlineDimensions = {settingTitle.w + settingTitle.x, currentY + settingTitle.h, 390 - settingTitle.x - settingTitle.w, 2};
-
-    if (currentSelectedTextBox == settingID + ".value") {
-        SDL_SetRenderDrawColor(renderer, selectedColor.r, selectedColor.g, selectedColor.b, selectedColor.a);
-    } else if(isHovering(settingID + ".value", textBoxUnderlineDimensions.x, textBoxUnderlineDimensions.y - settingTitle.h,
-        textBoxUnderlineDimensions.w, settingTitle.h)) {
-        SDL_SetRenderDrawColor(renderer, hoverColor.r, hoverColor.g, hoverColor.b, hoverColor.a);
+void Settings::SettingsIterate() {
+    if (this->showTraceHud && SDL_GetTicksNS() - lastTraceHudNS >= TRACE_HUD_REFRESH_NS) {
+        this->needsRedraw = true;
+    }
+    if (!this->needsRedraw) {
+        return;
+    }
+    this->needsRedraw = false;
+    SDL_SetRenderDrawColor(renderer, 15, 15, 20, 255);
+    SDL_RenderClear(renderer);
+    int outputWidth = 0;
+    int outputHeight = 0;
+    SDL_GetCurrentRenderOutputSize(renderer, &outputWidth, &outputHeight);
+    const auto viewportWidth = static_cast<float>(outputWidth);
+    const auto viewportHeight = static_cast<float>(outputHeight);
+    // only rows inside the viewport are rendered, rows that scrolled out give their textures back
+    for (Settings_Widget &widget: widgets) {
+        const float y = widget.y - scrollY;
+        const bool visible = y + widget.height > 0 && y < viewportHeight;
+        if (visible) {
+            DrawWidget(widget, y, viewportWidth);
+        } else if (widget.visible) {
+            textManager->DestroyText(widget.labelKey);
+            if (!widget.valueKey.empty()) {
+                textManager->DestroyText(widget.valueKey);
+            }
+        }
+        widget.visible = visible;
     }
-    else {
+    if (contentHeight > viewportHeight) {
+        const float thumbHeight = viewportHeight * viewportHeight / contentHeight;
+        const SDL_FRect thumb = {viewportWidth - 4 * uiScale, scrollY / contentHeight * viewportHeight, 3 * uiScale,
+                                 thumbHeight};
         SDL_SetRenderDrawColor(renderer, unSelectedColor.r, unSelectedColor.g, unSelectedColor.b, unSelectedColor.a);
+        SDL_RenderFillRect(renderer, &thumb);
     }
-
-    SDL_RenderFillRect(renderer, &textBoxUnderlineDimensions);
-
-
-    SDL_FRect settingValueDimensions = textManager->RenderText(currentFont, settingID + ".value",
-        settingValue, settingTitle.w + settingTitle.x, currentY, {255, 255, 255, 255}, 0.5f);
-
-    if (currentSelectedTextBox == settingID + ".value") {
-        SDL_FRect textCursorDimensions = {settingValueDimensions.w + settingValueDimensions.x + 1, currentY, 2, settingTitle.h};
-        SDL_RenderFillRect(renderer, &textCursorDimensions);
+    if (this->showTraceHud) {
+        DrawTraceHud(viewportWidth, viewportHeight);
+    } else if (traceHudLines > 0) {
+        DrawTraceHud(viewportWidth, -1);
     }
-
-    currentY += settingTitle.h + 5;
+    SDL_RenderPresent(renderer);
+    // rows that just scrolled in only have a hit rect now
+    UpdateHover();
 }
 
-
-void Settings::SettingsIterate() {
-    currentY = 5;
-    this->currentHovered = "";
-    SDL_SetRenderDrawColor(renderer, 15, 15, 20, 255);
-    SDL_RenderClear(renderer);
-    SDL_FRect titleDimensions = textManager->RenderText(currentFont, "settings.title",
-        "Settings", 10 + currentX, currentY, {255, 255, 255, 255}, 1);
-    currentY += titleDimensions.h + 10;
-
-    drawOptionsSetting("Theme", "settings.theme",
-        this->theme == LIGHT ? themeValueStrings[0] : themeValueStrings[1], themeValueStrings, 2);
-    drawOptionsSetting("Lunch", "settings.lunch",
-        this->defaultLunch == LUNCH_A ? lunchValueStrings[0] : lunchValueStrings[1], lunchValueStrings, 2);
-
-    drawBooleanSetting(this->showProgressBar, "Show Progress Bar", "settings.showProgressBar");
-    drawBooleanSetting(this->showPercentage, "Show Percentage", "settings.showPercentage");
-    drawBooleanSetting(this->showSeconds, "Show Seconds", "settings.showSeconds");
-
-    drawTextSetting(this->fontLocation, "Font Location", "settings.fontLocation");
-
-    SDL_FRect periodAliasDimensions = textManager->RenderText(currentFont, "settings.periodAliases.title",
-        "Period Aliases: ", 10 + currentX, currentY, {255, 255, 255, 255}, 0.5f);
-    currentY += periodAliasDimensions.h + 5;
-    currentX += 10;
-    for (const auto& periodAlias : this->periodAliases) {
-        drawTextSetting(periodAlias.second, periodAlias.first, "settings.periodAliases." + periodAlias.first);
+void Settings::DrawTraceHud(const float viewportWidth, const float viewportHeight) {
+    lastTraceHudNS = SDL_GetTicksNS();
+    size_t lines = 0;
+    // a negative height only gives the textures of a hidden HUD back, line 0 is the title
+    if (viewportHeight >= 0) {
+        Trace_Summarize(SDL_NS_PER_SECOND, traceEvents, traceStages);
+        TTF_Font *font = fontCache->Get(heldRowSize);
+        const auto lineHeight = static_cast<float>(TTF_GetFontHeight(font));
+        const float padding = 5 * uiScale;
+        const float top = viewportHeight - padding - lineHeight * static_cast<float>(traceStages.size() + 1);
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 200);
+        const SDL_FRect background = {0, top - padding, viewportWidth, viewportHeight - top + padding};
+        SDL_RenderFillRect(renderer, &background);
+
+        textManager->RenderText(font, "settings.trace.0", "Last second (F12 writes trace.json):", 2 * padding, top,
+                                hoverColor, 1);
+        lines++;
+        for (const auto &[name, count, totalNS, maxNS]: traceStages) {
+            const std::string text = std::format("{}: {}x, avg {:.1f} us, max {:.1f} us", name, count,
+                                                 static_cast<double>(totalNS) / static_cast<double>(count) / 1000.0,
+                                                 static_cast<double>(maxNS) / 1000.0);
+            textManager->RenderText(font, "settings.trace." + std::to_string(lines), text, 2 * padding,
+                                    top + lineHeight * static_cast<float>(lines), unSelectedColor, 1);
+            lines++;
+        }
     }
-    currentX -= 10;
-
-    SDL_RenderPresent(renderer);
+    // stages that didn't run within the last second leave their line behind
+    for (size_t line = lines; line < traceHudLines; ++line) {
+        textManager->DestroyText("settings.trace." + std::to_string(line));
+    }
+    traceHudLines = lines;
 }
 
-void Settings::OnMouseDown() {
-    if (this->currentHovered == "settings.theme.value.Light") {
-        this->theme = LIGHT;
-    } else if (this->currentHovered == "settings.theme.value.Dark") {
-        this->theme = DARK;
-    } else if (this->currentHovered == "settings.lunch.value.Lunch A") {
-        this->defaultLunch = LUNCH_A;
-        this->currentLunch = this->defaultLunch;
-    } else if (this->currentHovered == "settings.lunch.value.Lunch B") {
-        this->defaultLunch = LUNCH_B;
-        this->currentLunch = this->defaultLunch;
-    } else if (this->currentHovered == "settings.showPercentage.value") {
-        this->showPercentage = !this->showPercentage;
-    } else if (this->currentHovered == "settings.showProgressBar.value") {
-        this->showProgressBar = !this->showProgressBar;
-    }
-    else if (this->currentHovered == "settings.showSeconds.value") {
-        this->showSeconds = !this->showSeconds;
-    }
-    bool selectedTextBox = false;
-    for (const auto &key: this->periodAliases | std::views::keys) {
-        if (this->currentHovered == "settings.periodAliases." + key + ".value") {
-            this->currentSelectedTextBox = "settings.periodAliases." + key + ".value";
+void Settings::SelectTextBox(const int widget) {
+    if (widget == selectedTextBox) {
+        return;
+    }
+    // a font path is only applied once it is committed, not for every half typed path
+    if (selectedTextBox >= 0 && widgets[selectedTextBox].textValue == &this->fontLocation &&
+        std::filesystem::exists(this->fontLocation)) {
+        ApplyFontLocation();
+    }
+    if (widget < 0) {
+        SDL_StopTextInput(window);
+    } else {
+        if (selectedTextBox < 0) {
             SDL_StartTextInput(window);
-            selectedTextBox = true;
         }
+        textCursor = widgets[widget].textValue->size();
+    }
+    selectedTextBox = widget;
+}
+
+void Settings::OnMouseDown() {
+    if (hoveredWidget < 0) {
+        SelectTextBox(-1);
+        return;
     }
-    if (this->currentHovered == "settings.fontLocation.value") {
-        this->currentSelectedTextBox = "settings.fontLocation.value";
-        SDL_StartTextInput(window);
-        selectedTextBox = true;
+    Settings_Widget &widget = widgets[hoveredWidget];
+    switch (widget.kind) {
+        case SETTINGS_WIDGET_OPTION:
+            widget.select();
+            Save();
+            break;
+        case SETTINGS_WIDGET_TOGGLE:
+            *widget.toggleValue = !*widget.toggleValue;
+            Save();
+            break;
+        case SETTINGS_WIDGET_TEXT:
+            SelectTextBox(hoveredWidget);
+            return;
+        default:;
     }
-    if (!selectedTextBox) {
-        if (!this->currentSelectedTextBox.empty()) {
-            SDL_StopTextInput(window);
-        }
-        this->currentSelectedTextBox = "";
+    SelectTextBox(-1);
+}
+
+// moves over whole UTF-8 sequences so the cursor never ends up inside a character
+static size_t PreviousCharacter(const std::string &text, size_t index) {
+    while (index > 0 && (static_cast<unsigned char>(text[--index]) & 0xC0) == 0x80) {}
+    return index;
+}
+
+static size_t NextCharacter(const std::string &text, size_t index) {
+    while (index < text.size() && (static_cast<unsigned char>(text[++index]) & 0xC0) == 0x80) {}
+    return std::min(index, text.size());
+}
+
+void Settings::OnKeyDown(const SDL_Keycode key) {
+    if (selectedTextBox < 0) {
+        return;
+    }
+    std::string &text = *widgets[selectedTextBox].textValue;
+    switch (key) {
+        case SDLK_BACKSPACE:
+            if (textCursor > 0) {
+                const size_t start = PreviousCharacter(text, textCursor);
+                text.erase(start, textCursor - start);
+                textCursor = start;
+                OnTextChanged();
+            }
+            break;
+        case SDLK_DELETE:
+            if (textCursor < text.size()) {
+                text.erase(textCursor, NextCharacter(text, textCursor) - textCursor);
+                OnTextChanged();
+            }
+            break;
+        case SDLK_LEFT:
+            textCursor = PreviousCharacter(text, textCursor);
+            break;
+        case SDLK_RIGHT:
+            textCursor = NextCharacter(text, textCursor);
+            break;
+        case SDLK_HOME:
+            textCursor = 0;
+            break;
+        case SDLK_END:
+            textCursor = text.size();
+            break;
+        case SDLK_RETURN:
+        case SDLK_ESCAPE:
+            SelectTextBox(-1);
+            break;
+        default:;
     }
 }
 
+void Settings::OnTextChanged() {
+    if (widgets[selectedTextBox].valueKey.starts_with("settings.periodAliases.")) {
+        eventNamesDirty = true;
+    }
+    Save();
+}
 
+void Settings::OnTextInput(const char *text) {
+    if (selectedTextBox < 0) {
+        return;
+    }
+    // edited in place, the string only reallocates when it outgrows its capacity
+    const size_t length = std::strlen(text);
+    widgets[selectedTextBox].textValue->insert(textCursor, text, length);
+    textCursor += length;
+    OnTextChanged();
+}
 
 void Settings::PollEvent(SDL_Event* event) {
     SDL_WindowID windowID = SDL_GetWindowID(window);
     if (event->window.windowID == windowID) {
+        // mouse positions come in points, the rows are laid out in pixels
+        SDL_ConvertEventToRenderCoordinates(renderer, event);
         switch (event->type) {
             case SDL_EVENT_WINDOW_CLOSE_REQUESTED:
                 this->CloseSettings();
@@ -296,32 +682,53 @@ void Settings::PollEvent(SDL_Event* event) {
             case SDL_EVENT_WINDOW_FOCUS_LOST:
                 hasFocus = false;
                 break;
+            case SDL_EVENT_WINDOW_RESIZED:
+                // a taller window may not need to be scrolled as far anymore
+                ScrollBy(0);
+                needsRedraw = true;
+                break;
+            case SDL_EVENT_WINDOW_DISPLAY_SCALE_CHANGED:
+                // moved to a display with another scale, the rows are rebuilt with fonts opened at the new size
+                SelectTextBox(-1);
+                HoldFonts();
+                BuildWidgets();
+                hoveredWidget = -1;
+                ScrollBy(0);
+                needsRedraw = true;
+                break;
+            case SDL_EVENT_WINDOW_SHOWN:
+            case SDL_EVENT_WINDOW_EXPOSED:
+            case SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED:
+                needsRedraw = true;
+                break;
+            case SDL_EVENT_WINDOW_MOUSE_LEAVE:
+                this->mouseX = -1;
+                this->mouseY = -1;
+                UpdateHover();
+                break;
             case SDL_EVENT_MOUSE_MOTION:
                 this->mouseX = event->motion.x;
                 this->mouseY = event->motion.y;
+                UpdateHover();
+                break;
+            case SDL_EVENT_MOUSE_WHEEL:
+                ScrollBy(-event->wheel.y * SCROLL_STEP * uiScale);
                 break;
             case SDL_EVENT_MOUSE_BUTTON_DOWN:
                 if (event->button.button == SDL_BUTTON_LEFT) {
                     this->OnMouseDown();
+                    needsRedraw = true;
                 }
                 break;
             case SDL_EVENT_KEY_DOWN:
-                if(event->key.key == SDLK_BACKSPACE) {
-                    std::string str = getTextBoxSetting(this->currentSelectedTextBox);
-                    if (str.length() > 1) {
-                        str.pop_back();
-                    } else {
-                        str = "";
-                    }
-                    changeTextBoxSetting(this->currentSelectedTextBox, str);
-                }
-            break;
+                OnKeyDown(event->key.key);
+                needsRedraw = true;
+                break;
             case SDL_EVENT_TEXT_INPUT:
-                std::string str = getTextBoxSetting(this->currentSelectedTextBox);
-                str.append(event->text.text);
-                changeTextBoxSetting(this->currentSelectedTextBox, str);
-            break;
+                OnTextInput(event->text.text);
+                needsRedraw = true;
+                break;
+            default:;
         }
     }
 }
-
@@ -2,10 +2,15 @@
 #include <map>
 
 
+#include "EventNameTable.h"
+#include "FontCache.h"
+#include "SettingsWriter.h"
 #include "TextManager.h"
+#include "Trace.h"
 
 
 #include <SDL3/SDL_render.h>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -13,46 +18,131 @@ enum Theme {
     DARK = 0,
     LIGHT = 1
 };
-enum Lunch {
-    LUNCH_A = 0,
-    LUNCH_B = 1
+
+// How often the trace HUD in the settings window is refreshed while it is shown.
+static constexpr Uint64 TRACE_HUD_REFRESH_NS = 500'000'000;
+
+// What a reload of the settings file changed, so only that has to be reapplied.
+enum Settings_Change : unsigned {
+    SETTINGS_CHANGE_NONE = 0,
+    // theme, progress bar, seconds, percentage, text size and the trace HUD
+    SETTINGS_CHANGE_DISPLAY = 1 << 0,
+    SETTINGS_CHANGE_FONT = 1 << 1,
+    SETTINGS_CHANGE_TIME_ZONE = 1 << 2,
+    SETTINGS_CHANGE_LUNCH = 1 << 3,
+    SETTINGS_CHANGE_ALIASES = 1 << 4
+};
+
+enum Settings_LoadResult {
+    // not JSON, nothing was applied
+    SETTINGS_LOAD_INVALID,
+    // applied, but some settings were missing or had the wrong type and kept their current value
+    SETTINGS_LOAD_INCOMPLETE,
+    SETTINGS_LOAD_OK
+};
+
+enum Settings_WidgetKind {
+    SETTINGS_WIDGET_LABEL,
+    SETTINGS_WIDGET_OPTION,
+    SETTINGS_WIDGET_TOGGLE,
+    SETTINGS_WIDGET_TEXT
+};
+
+// One row of the settings window. The table is built once when the window opens, so drawing and input handling
+// only index into it and never build strings.
+struct Settings_Widget {
+    Settings_WidgetKind kind;
+    float x;
+    float fontSize;
+    float spacingAfter;
+    std::string label;
+    std::string labelKey;
+    std::string valueKey;
+    bool* toggleValue = nullptr;
+    std::string* textValue = nullptr;
+    std::function<bool()> isSelected;
+    std::function<void()> select;
+    // position in the scrollable content, laid out once when the table is built
+    float y = 0;
+    float height = 0;
+    bool visible = false;
+    // hit-test area in content coordinates from the last draw
+    SDL_FRect rect{};
+    TTF_Font* font = nullptr;
 };
 
 class Settings {
     std::string saveFilePath;
-    void Load();
+    SettingsWriter writer;
+    bool Load();
+    Settings_LoadResult LoadFrom(const std::string& text);
+    [[nodiscard]] std::string Serialize() const;
     bool isOpen = false;
     bool hasFocus = false;
     SDL_Window *window = nullptr;
     SDL_Renderer *renderer = nullptr;
     TextManager *textManager = nullptr;
-    TTF_Font *currentFont = nullptr;
+    FontCache *fontCache = nullptr;
     float mouseX = 0;
     float mouseY = 0;
 
-    float currentX = 0;
-    float currentY = 0;
-    std::string currentHovered;
-    std::string currentSelectedTextBox;
-    bool isHovering(std::string settingsValue, float x, float y, float width, float height);
+    std::vector<Settings_Widget> widgets;
+    int hoveredWidget = -1;
+    int selectedTextBox = -1;
+    // byte offset of the text cursor in the selected text box
+    size_t textCursor = 0;
+    float scrollY = 0;
+    float contentHeight = 0;
+    // display scale of the settings window, every font size and row metric below is multiplied by it
+    float uiScale = 1;
+    // font sizes acquired for the current scale, 0 while the window is closed
+    float heldTitleSize = 0;
+    float heldRowSize = 0;
+    bool HoldFonts();
+    void ReleaseFonts();
+    // the window is only drawn again when an event changed what it shows
+    bool needsRedraw = true;
+    void BuildWidgets();
+    void LayoutWidgets();
+    void ScrollBy(float delta);
+    void UpdateHover();
+    void SelectTextBox(int widget);
+    void OnKeyDown(SDL_Keycode key);
+    void OnTextInput(const char* text);
+    void DrawWidget(Settings_Widget& widget, float y, float viewportWidth);
+    void OnTextChanged();
+    // when the last change is serialized and handed to the writer, 0 if nothing is waiting
+    Uint64 saveAtNS = 0;
+    // an alias box was edited, the names are rebuilt together with the save
+    bool eventNamesDirty = false;
+    // tracks in the schedule on screen, the settings window lists one lunch option per track
+    int trackCount = 2;
+    EventNameTable eventNames;
 
-    void drawBooleanSetting(bool settingValue, const std::string& settingName, const std::string& settingID);
-    void drawOptionsSetting(const std::string &settingName, const std::string &settingID,
-                            const std::string &currentValue, std::string *values, int valuesLength);
-    void drawTextSetting(const std::string& settingValue, const std::string& settingName, const std::string& settingID);
-    std::string getTextBoxSetting(const std::string &textBoxID);
-    void changeTextBoxSetting(const std::string &textBoxID, const std::string& str);
-    std::string *themeValueStrings = new std::string[]{"Light", "Dark"};
-    std::string *lunchValueStrings = new std::string[]{"Lunch A", "Lunch B"};
+    // reused between HUD refreshes
+    std::vector<Trace_Event> traceEvents;
+    std::vector<Trace_Stage> traceStages;
+    Uint64 lastTraceHudNS = 0;
+    size_t traceHudLines = 0;
+    void DrawTraceHud(float viewportWidth, float viewportHeight);
 public:
     Theme theme = DARK;
     bool showProgressBar = true;
     bool showSeconds = true;
     bool showPercentage = false;
+    // draws only the countdown, in a bigger font
+    bool largeText = false;
+    // shows the recent trace scopes at the bottom of the settings window
+    bool showTraceHud = false;
     std::string fontLocation = "./assets/fonts/SegoeUI.ttf";
-    Lunch defaultLunch = LUNCH_A;
-    Lunch currentLunch = LUNCH_A;
-    std::pmr::map<std::string, std::string> periodAliases = {
+    // IANA name of the zone the schedule times are in
+    std::string timeZone = "America/New_York";
+    // index of the schedule track to show, Lunch A is 0. The default is kept as saved even when today's schedule
+    // has fewer tracks, the current one is clamped to the tracks that exist.
+    int defaultLunch = 0;
+    int currentLunch = 0;
+    // keyed by the built-in event names, or "Event N" for codes without one. Call RebuildEventNames after changing it.
+    std::pmr::map<std::string, std::string, std::less<>> periodAliases = {
         {"Nothing", "Nothing"},
         {"Period 1", "Period 1"},
         {"Period 2", "Period 2"},
@@ -72,7 +162,28 @@ public:
         {"PSAT/SAT", "PSAT/SAT"}
     };
     explicit Settings(const std::string &saveFilePath);
+    // marks the settings as changed. They are serialized once no change came in for the debounce time, see SaveIfDue
     void Save();
+    // serializes and queues the write once the debounce has run out, called from the main loop
+    void SaveIfDue();
+    [[nodiscard]] Uint64 GetSaveDeadlineNS() const { return this->saveAtNS; }
+    // writes pending changes right away and waits until they are on disk
+    void Flush();
+    void SetFontCache(FontCache* fontCache) { this->fontCache = fontCache; }
+    // drops the settings window's textures made with a font the cache is about to close
+    void OnFontClosed(TTF_Font* font) const;
+    // re-reads the file after it changed on disk and returns the Settings_Change flags of what changed
+    unsigned Reload();
+    // called with every schedule that is shown, switching the track list when the count changed
+    void SetTrackCount(int count);
+    void RebuildEventNames() {
+        eventNames.Rebuild(this->periodAliases);
+        eventNamesDirty = false;
+    }
+    [[nodiscard]] const EventNameTable& GetEventNames() const { return this->eventNames; }
+    // switches the shared font cache to fontLocation
+    void ApplyFontLocation();
+    [[nodiscard]] bool IsTraceHudShown() const { return this->isOpen && this->showTraceHud; }
     [[nodiscard]] bool isSettingsOpen() const {
         return this->isOpen;
     }
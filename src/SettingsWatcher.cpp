@@ -0,0 +1,152 @@
+#include "SettingsWatcher.h"
+
+#include <SDL3/SDL_log.h>
+#include <cstdint>
+#include <filesystem>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+#if !defined(__linux__) && !defined(_WIN32)
+static constexpr auto POLL_INTERVAL = std::chrono::seconds(2);
+#endif
+
+SettingsWatcher::SettingsWatcher(std::string filePath, ChangeHandler onChange) :
+    filePath(std::move(filePath)), onChange(std::move(onChange)) {
+#if defined(__linux__)
+    this->stopFd = eventfd(0, EFD_CLOEXEC);
+#elif defined(_WIN32)
+    this->stopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+#endif
+    this->worker = std::thread(&SettingsWatcher::Run, this);
+}
+
+SettingsWatcher::~SettingsWatcher() {
+#if defined(__linux__)
+    stopping = true;
+    constexpr uint64_t wake = 1;
+    if (stopFd >= 0 && write(stopFd, &wake, sizeof(wake)) < 0) {
+        SDL_Log("Couldn't wake the settings watcher");
+    }
+#elif defined(_WIN32)
+    stopping = true;
+    if (stopEvent != nullptr) {
+        SetEvent(stopEvent);
+    }
+#else
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    wakeup.notify_all();
+#endif
+    if (worker.joinable()) {
+        worker.join();
+    }
+#if defined(__linux__)
+    if (stopFd >= 0) {
+        close(stopFd);
+    }
+#elif defined(_WIN32)
+    if (stopEvent != nullptr) {
+        CloseHandle(stopEvent);
+    }
+#endif
+}
+
+#if !defined(__linux__)
+static std::filesystem::file_time_type LastWriteTime(const std::filesystem::path &path) {
+    std::error_code error;
+    const auto time = std::filesystem::last_write_time(path, error);
+    return error ? std::filesystem::file_time_type::min() : time;
+}
+#endif
+
+void SettingsWatcher::Run() {
+    // the file is replaced by a rename when saved, so the directory is watched rather than the file itself
+    const std::filesystem::path path = std::filesystem::absolute(filePath);
+    const std::filesystem::path directory = path.parent_path();
+    const std::string fileName = path.filename().string();
+
+#if defined(__linux__)
+    const int inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (stopFd < 0 || inotifyFd < 0 ||
+        inotify_add_watch(inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        SDL_Log("Couldn't watch %s for settings changes", directory.c_str());
+        if (inotifyFd >= 0) {
+            close(inotifyFd);
+        }
+        return;
+    }
+    alignas(inotify_event) char buffer[4096];
+    while (!stopping) {
+        pollfd pollFds[] = {{inotifyFd, POLLIN, 0}, {stopFd, POLLIN, 0}};
+        if (poll(pollFds, 2, -1) <= 0 || (pollFds[0].revents & POLLIN) == 0) {
+            continue;
+        }
+        bool changed = false;
+        ssize_t length;
+        while ((length = read(inotifyFd, buffer, sizeof(buffer))) > 0) {
+            for (ssize_t offset = 0; offset < length;) {
+                const auto *event = reinterpret_cast<const inotify_event *>(buffer + offset);
+                if (event->len > 0 && fileName == event->name) {
+                    changed = true;
+                }
+                offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+            }
+        }
+        if (changed) {
+            onChange();
+        }
+    }
+    close(inotifyFd);
+#elif defined(_WIN32)
+    const HANDLE notification = FindFirstChangeNotificationW(
+            directory.c_str(), FALSE, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME);
+    if (stopEvent == nullptr || notification == INVALID_HANDLE_VALUE) {
+        SDL_Log("Couldn't watch %s for settings changes", directory.string().c_str());
+        if (notification != INVALID_HANDLE_VALUE) {
+            FindCloseChangeNotification(notification);
+        }
+        return;
+    }
+    // notifications cover the whole directory, the modification time tells whether it was our file
+    auto lastWriteTime = LastWriteTime(path);
+    const HANDLE handles[] = {notification, static_cast<HANDLE>(stopEvent)};
+    while (!stopping) {
+        if (WaitForMultipleObjects(2, handles, FALSE, INFINITE) != WAIT_OBJECT_0) {
+            continue;
+        }
+        if (const auto writeTime = LastWriteTime(path); writeTime != lastWriteTime) {
+            lastWriteTime = writeTime;
+            onChange();
+        }
+        if (!FindNextChangeNotification(notification)) {
+            break;
+        }
+    }
+    FindCloseChangeNotification(notification);
+#else
+    auto lastWriteTime = LastWriteTime(path);
+    while (true) {
+        {
+            std::unique_lock lock(mutex);
+            if (wakeup.wait_for(lock, POLL_INTERVAL, [this] { return stopping.load(); })) {
+                return;
+            }
+        }
+        if (const auto writeTime = LastWriteTime(path); writeTime != lastWriteTime) {
+            lastWriteTime = writeTime;
+            onChange();
+        }
+    }
+#endif
+}
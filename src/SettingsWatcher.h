@@ -0,0 +1,36 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Watches the settings file for changes made outside the app (e.g. a file pushed to every lab machine) and calls
+// the change handler from its own thread. Uses inotify on Linux and change notifications on Windows, anywhere
+// else it falls back to polling the modification time. The worker blocks until the file changes or the watcher is
+// destroyed, so it never wakes up while nothing happens.
+class SettingsWatcher {
+public:
+    using ChangeHandler = std::function<void()>;
+private:
+    std::string filePath;
+    ChangeHandler onChange;
+    std::atomic<bool> stopping = false;
+    // signalled by the destructor to wake the blocked worker
+#if defined(__linux__)
+    int stopFd = -1;
+#elif defined(_WIN32)
+    void* stopEvent = nullptr;
+#else
+    std::mutex mutex;
+    std::condition_variable wakeup;
+#endif
+    std::thread worker;
+    void Run();
+public:
+    SettingsWatcher(std::string filePath, ChangeHandler onChange);
+    ~SettingsWatcher();
+    SettingsWatcher(const SettingsWatcher&) = delete;
+    SettingsWatcher& operator=(const SettingsWatcher&) = delete;
+};
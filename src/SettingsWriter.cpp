@@ -0,0 +1,111 @@
+#include "SettingsWriter.h"
+
+#include <SDL3/SDL_log.h>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+SettingsWriter::SettingsWriter(std::string filePath, const std::chrono::milliseconds debounce) :
+    filePath(std::move(filePath)), debounce(debounce) {
+    this->worker = std::thread(&SettingsWriter::Run, this);
+}
+
+SettingsWriter::~SettingsWriter() {
+    Flush();
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    wakeup.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void SettingsWriter::MarkWritten(std::string content) {
+    std::lock_guard lock(mutex);
+    writtenContent = std::move(content);
+}
+
+bool SettingsWriter::ReadExternalChange(std::string &text) {
+    std::lock_guard fileLock(fileMutex);
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    text.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    if (!file.good() && !file.eof()) {
+        return false;
+    }
+    std::lock_guard lock(mutex);
+    return text != writtenContent;
+}
+
+void SettingsWriter::Write(std::string content) {
+    {
+        std::lock_guard lock(mutex);
+        pendingContent = std::move(content);
+        hasPending = true;
+        writeAt = std::chrono::steady_clock::now() + debounce;
+    }
+    wakeup.notify_all();
+}
+
+void SettingsWriter::Flush() {
+    std::unique_lock lock(mutex);
+    if (!hasPending && !writing) {
+        return;
+    }
+    flushRequested = true;
+    wakeup.notify_all();
+    wakeup.wait(lock, [this] { return (!hasPending && !writing) || stopping; });
+}
+
+void SettingsWriter::Run() {
+    std::unique_lock lock(mutex);
+    while (true) {
+        wakeup.wait(lock, [this] { return hasPending || stopping; });
+        if (!hasPending) {
+            return;
+        }
+        // every new change pushes writeAt back, so only the last change of a burst gets written
+        while (!stopping && !flushRequested && std::chrono::steady_clock::now() < writeAt) {
+            wakeup.wait_until(lock, writeAt);
+        }
+        std::string content = std::move(pendingContent);
+        hasPending = false;
+        flushRequested = false;
+        if (content != writtenContent) {
+            writing = true;
+            lock.unlock();
+            std::unique_lock fileLock(fileMutex);
+            const bool written = WriteFile(content);
+            lock.lock();
+            writing = false;
+            if (written) {
+                writtenContent = std::move(content);
+            }
+            fileLock.unlock();
+        }
+        wakeup.notify_all();
+    }
+}
+
+bool SettingsWriter::WriteFile(const std::string &content) const {
+    const std::string tempFilePath = filePath + ".tmp";
+    {
+        std::ofstream file(tempFilePath, std::ios::binary | std::ios::trunc);
+        file.write(content.data(), static_cast<std::streamsize>(content.size()));
+        if (!file.good()) {
+            SDL_Log("Couldn't write settings %s", tempFilePath.c_str());
+            return false;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(tempFilePath, filePath, error);
+    if (error) {
+        SDL_Log("Couldn't replace settings %s: %s", filePath.c_str(), error.message().c_str());
+        return false;
+    }
+    return true;
+}
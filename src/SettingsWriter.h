@@ -0,0 +1,41 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Writes the settings file on its own thread. A burst of changes is collapsed into one write once no new change
+// came in for the debounce time, identical content is never written twice, and every write goes to a temporary
+// file that is renamed over the old one, so a crash can't leave a half written file behind.
+class SettingsWriter {
+    std::string filePath;
+    std::chrono::milliseconds debounce;
+    std::mutex mutex;
+    // held from writing the temporary file until writtenContent matches the renamed file, and while
+    // ReadExternalChange reads it, so our own save is always recognised. Always taken before mutex.
+    std::mutex fileMutex;
+    std::condition_variable wakeup;
+    std::string pendingContent;
+    std::string writtenContent;
+    bool hasPending = false;
+    bool writing = false;
+    bool flushRequested = false;
+    bool stopping = false;
+    std::chrono::steady_clock::time_point writeAt{};
+    std::thread worker;
+    void Run();
+    bool WriteFile(const std::string& content) const;
+public:
+    SettingsWriter(std::string filePath, std::chrono::milliseconds debounce);
+    ~SettingsWriter();
+    SettingsWriter(const SettingsWriter&) = delete;
+    SettingsWriter& operator=(const SettingsWriter&) = delete;
+    // tells the writer what is already on disk, so writing the same content again is skipped
+    void MarkWritten(std::string content);
+    // reads the file into text and returns true only if it holds something this writer didn't write
+    bool ReadExternalChange(std::string& text);
+    void Write(std::string content);
+    // blocks until the pending content, if any, is on disk
+    void Flush();
+};
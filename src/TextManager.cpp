@@ -1,45 +1,195 @@
 #include "TextManager.h"
 
+#include <SDL3/SDL_log.h>
 #include <SDL3_ttf/SDL_ttf.h>
+#include <algorithm>
+#include <ranges>
 #include <string>
 #include <unordered_map>
 
-SDL_FRect TextManager::RenderText(TTF_Font *font, const std::string &textKey, const std::string &text, const float x,
-                                  const float y, const SDL_Color color, const float scale) {
+#include "Trace.h"
+
+static size_t TextureBytes(const SDL_Texture *texture) {
+    return static_cast<size_t>(texture->w) * static_cast<size_t>(texture->h) * 4;
+}
+
+TextManager::~TextManager() {
+    for (const auto &data: textures) {
+        SDL_DestroyTexture(data.texture);
+    }
+    for (const auto &atlas: atlasMap | std::views::values) {
+        if (atlas.texture != nullptr) {
+            SDL_DestroyTexture(atlas.texture);
+        }
+    }
+}
+
+SDL_FRect TextManager::RenderText(TTF_Font *font, const std::string_view textKey, const std::string_view text,
+                                  const float x, const float y, const SDL_Color color, const float scale) {
     if (!text.empty()) {
-        TextureData *data = textureMap[textKey];
-        bool newTexture = false;
-        if (data == nullptr || data->texture == nullptr || data->text != text || data->color.r != color.r ||
-            data->color.g != color.g || data->color.b != color.b) {
-            if (data != nullptr) {
+        Trace_Scope scope("RenderText hit");
+        auto it = textureMap.find(textKey);
+        // the color isn't part of the texture, so color animations never need a new texture
+        if (it != textureMap.end() && it->second->text == text && it->second->font == font) {
+            stats.hits++;
+            textures.splice(textures.begin(), textures, it->second);
+        } else {
+            stats.misses++;
+            scope.SetName("RenderText rasterize");
+            SDL_Surface *surface = TTF_RenderText_Blended(font, text.data(), text.size(), {255, 255, 255, 255});
+            SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
+            SDL_DestroySurface(surface);
+            stats.rasterizations++;
+            stats.textureCreations++;
+            if (texture == nullptr) {
                 DestroyText(textKey);
+                return SDL_FRect{x, y, 0, static_cast<float>(TTF_GetFontHeight(font))};
             }
-            SDL_Surface *surface = TTF_RenderText_Blended(font, text.c_str(), 0, color);
-            data = new TextureData{.texture = SDL_CreateTextureFromSurface(renderer, surface),
-                                   .text = text,
-                                   .color = color,
-                                   .font = font};
-            SDL_DestroySurface(surface);
-            newTexture = true;
-        }
-        const SDL_FRect dstRect = {x, y, static_cast<float>(data->texture->w) * scale,
-                                   static_cast<float>(data->texture->h) * scale};
-        SDL_RenderTexture(renderer, data->texture, nullptr, &dstRect);
-        if (newTexture) {
-            textureMap[textKey] = data;
+            if (it == textureMap.end()) {
+                textures.push_front({.key = std::string(textKey), .texture = nullptr, .text = {}, .font = nullptr, .bytes = 0});
+                it = textureMap.emplace(textKey, textures.begin()).first;
+                stats.textureCount++;
+            } else {
+                textures.splice(textures.begin(), textures, it->second);
+                SDL_DestroyTexture(it->second->texture);
+                stats.textureBytes -= it->second->bytes;
+            }
+            TextureData &data = *it->second;
+            data.texture = texture;
+            data.text = text;
+            data.font = font;
+            data.bytes = TextureBytes(texture);
+            stats.textureBytes += data.bytes;
+            EvictToBudget();
         }
+        const TextureData &data = *it->second;
+        const SDL_FRect dstRect = {x, y, static_cast<float>(data.texture->w) * scale,
+                                   static_cast<float>(data.texture->h) * scale};
+        SDL_SetTextureColorMod(data.texture, color.r, color.g, color.b);
+        SDL_SetTextureAlphaMod(data.texture, color.a);
+        SDL_RenderTexture(renderer, data.texture, nullptr, &dstRect);
         return dstRect;
     }
     return SDL_FRect{x, y, 0, static_cast<float>(TTF_GetFontHeight(font))};
 }
 
-void TextManager::DestroyText(const std::string &textKey) {
-    if (const TextureData *data = textureMap[textKey]; data != nullptr) {
-        if (data->texture != nullptr) {
-            SDL_DestroyTexture(data->texture);
+void TextManager::EvictToBudget() {
+    // never evict the front entry, it is the one being drawn right now
+    while (stats.textureBytes > textureBudget && textures.size() > 1) {
+        const TextureData &data = textures.back();
+        SDL_DestroyTexture(data.texture);
+        stats.textureBytes -= data.bytes;
+        stats.textureCount--;
+        stats.evictions++;
+        textureMap.erase(data.key);
+        textures.pop_back();
+    }
+}
+
+void TextManager::DestroyText(const std::string_view textKey) {
+    if (const auto it = textureMap.find(textKey); it != textureMap.end()) {
+        SDL_DestroyTexture(it->second->texture);
+        stats.textureBytes -= it->second->bytes;
+        stats.textureCount--;
+        textures.erase(it->second);
+        textureMap.erase(it);
+    }
+}
+
+void TextManager::DestroyFontTexts(TTF_Font *font) {
+    for (auto it = textures.begin(); it != textures.end();) {
+        if (it->font != font) {
+            ++it;
+            continue;
         }
-        textureMap[textKey] = nullptr;
-        textureMap.erase(textKey);
-        delete data;
+        SDL_DestroyTexture(it->texture);
+        stats.textureBytes -= it->bytes;
+        stats.textureCount--;
+        textureMap.erase(it->key);
+        it = textures.erase(it);
+    }
+    // a new font can be allocated at the same address, so its atlas must not survive either
+    if (const auto it = atlasMap.find(font); it != atlasMap.end()) {
+        if (it->second.texture != nullptr) {
+            stats.atlasBytes -= TextureBytes(it->second.texture);
+            stats.atlasCount--;
+            SDL_DestroyTexture(it->second.texture);
+        }
+        atlasMap.erase(it);
+    }
+}
+
+GlyphAtlas *TextManager::GetAtlas(TTF_Font *font) {
+    if (const auto it = atlasMap.find(font); it != atlasMap.end()) {
+        return it->second.texture != nullptr ? &it->second : nullptr;
+    }
+    // rasterize every glyph once in white, the color is applied with color modulation when drawing
+    std::array<SDL_Surface *, ATLAS_GLYPHS.size()> surfaces{};
+    int atlasWidth = 0;
+    int atlasHeight = 0;
+    for (size_t i = 0; i < ATLAS_GLYPHS.size(); ++i) {
+        surfaces[i] = TTF_RenderText_Blended(font, &ATLAS_GLYPHS[i], 1, {255, 255, 255, 255});
+        stats.rasterizations++;
+        if (surfaces[i] != nullptr) {
+            // leave a pixel between glyphs so scaled sampling never bleeds into the neighbour
+            atlasWidth += surfaces[i]->w + 1;
+            atlasHeight = std::max(atlasHeight, surfaces[i]->h);
+        }
+    }
+
+    GlyphAtlas atlas = {.texture = nullptr, .glyphs = {}};
+    if (SDL_Surface *atlasSurface = SDL_CreateSurface(atlasWidth, atlasHeight, SDL_PIXELFORMAT_ARGB8888);
+        atlasSurface != nullptr) {
+        int glyphX = 0;
+        for (size_t i = 0; i < ATLAS_GLYPHS.size(); ++i) {
+            if (surfaces[i] == nullptr) {
+                continue;
+            }
+            const SDL_Rect dstRect = {glyphX, 0, surfaces[i]->w, surfaces[i]->h};
+            SDL_SetSurfaceBlendMode(surfaces[i], SDL_BLENDMODE_NONE);
+            SDL_BlitSurface(surfaces[i], nullptr, atlasSurface, &dstRect);
+            atlas.glyphs[i] = {static_cast<float>(glyphX), 0, static_cast<float>(surfaces[i]->w),
+                               static_cast<float>(surfaces[i]->h)};
+            glyphX += surfaces[i]->w + 1;
+        }
+        atlas.texture = SDL_CreateTextureFromSurface(renderer, atlasSurface);
+        stats.textureCreations++;
+        SDL_DestroySurface(atlasSurface);
+    }
+    for (SDL_Surface *surface: surfaces) {
+        SDL_DestroySurface(surface);
+    }
+    if (atlas.texture == nullptr) {
+        SDL_Log("Couldn't create glyph atlas: %s", SDL_GetError());
+    }
+
+    if (atlas.texture != nullptr) {
+        stats.atlasBytes += TextureBytes(atlas.texture);
+        stats.atlasCount++;
+    }
+    auto &inserted = atlasMap[font] = atlas;
+    return inserted.texture != nullptr ? &inserted : nullptr;
+}
+
+SDL_FRect TextManager::RenderNumericText(TTF_Font *font, const std::string_view textKey, const std::string_view text,
+                                         const float x, const float y, const SDL_Color color, const float scale) {
+    GlyphAtlas *atlas = !text.empty() && text.find_first_not_of(ATLAS_GLYPHS) == std::string_view::npos ? GetAtlas(font)
+                                                                                                   : nullptr;
+    if (atlas == nullptr) {
+        return RenderText(font, textKey, text, x, y, color, scale);
+    }
+    // the countdown changes every second, drawing it from the atlas avoids rasterizing a new texture each time
+    TRACE_SCOPE("RenderText atlas");
+    SDL_SetTextureColorMod(atlas->texture, color.r, color.g, color.b);
+    SDL_SetTextureAlphaMod(atlas->texture, color.a);
+    float penX = x;
+    float height = 0;
+    for (const char c: text) {
+        const SDL_FRect &srcRect = atlas->glyphs[ATLAS_GLYPHS.find(c)];
+        const SDL_FRect dstRect = {penX, y, srcRect.w * scale, srcRect.h * scale};
+        SDL_RenderTexture(renderer, atlas->texture, &srcRect, &dstRect);
+        penX += dstRect.w;
+        height = std::max(height, dstRect.h);
     }
+    return SDL_FRect{x, y, penX - x, height};
 }
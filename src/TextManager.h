@@ -1,24 +1,75 @@
 #pragma once
 #include <SDL3/SDL_render.h>
 #include <SDL3_ttf/SDL_ttf.h>
+#include <array>
+#include <list>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 
+// Texture memory a TextManager may keep around before it starts evicting the least recently used text. Glyph
+// atlases are not part of this, they stay alive until their font is closed.
+static constexpr size_t DEFAULT_TEXTURE_BUDGET = 4 * 1024 * 1024;
+
 struct TextureData {
+    std::string key;
     SDL_Texture* texture;
     std::string text;
-    SDL_Color color;
     TTF_Font* font;
+    size_t bytes;
+};
+
+struct TextManager_Stats {
+    Uint64 hits = 0;
+    Uint64 misses = 0;
+    Uint64 evictions = 0;
+    Uint64 rasterizations = 0;
+    Uint64 textureCreations = 0;
+    // string textures only, these are what the budget evicts
+    size_t textureBytes = 0;
+    size_t textureCount = 0;
+    // glyph atlases, kept outside the budget
+    size_t atlasBytes = 0;
+    size_t atlasCount = 0;
+};
+
+// hashes keys and string_views alike, so looking up a key never has to build a std::string
+struct TextManager_KeyHash {
+    using is_transparent = void;
+    size_t operator()(const std::string_view key) const { return std::hash<std::string_view>{}(key); }
+};
+
+// Characters that can be drawn from a glyph atlas instead of a per-string texture.
+static constexpr std::string_view ATLAS_GLYPHS = "0123456789:%.";
+
+struct GlyphAtlas {
+    SDL_Texture* texture;
+    std::array<SDL_FRect, ATLAS_GLYPHS.size()> glyphs;
 };
 
 class TextManager {
     SDL_Renderer *renderer;
-    TTF_Font *font = nullptr;
-    std::pmr::unordered_map<std::string, TextureData*> textureMap;
+    size_t textureBudget;
+    // most recently used entries are at the front, the map points into the list
+    std::pmr::list<TextureData> textures;
+    std::pmr::unordered_map<std::string, std::pmr::list<TextureData>::iterator, TextManager_KeyHash, std::equal_to<>>
+            textureMap;
+    std::pmr::unordered_map<TTF_Font*, GlyphAtlas> atlasMap;
+    TextManager_Stats stats;
+    GlyphAtlas* GetAtlas(TTF_Font* font);
+    void EvictToBudget();
 public:
-    explicit TextManager(SDL_Renderer* renderer) {
+    explicit TextManager(SDL_Renderer* renderer, size_t textureBudget = DEFAULT_TEXTURE_BUDGET) {
         this->renderer = renderer;
+        this->textureBudget = textureBudget;
     }
-    SDL_FRect RenderText(TTF_Font* font, const std::string& textKey, const std::string& text, float x, float y, SDL_Color color, float scale);
-    void DestroyText(const std::string& textKey);
+    ~TextManager();
+    TextManager(const TextManager&) = delete;
+    TextManager& operator=(const TextManager&) = delete;
+    SDL_FRect RenderText(TTF_Font* font, std::string_view textKey, std::string_view text, float x, float y, SDL_Color color, float scale);
+    SDL_FRect RenderNumericText(TTF_Font* font, std::string_view textKey, std::string_view text, float x, float y, SDL_Color color, float scale);
+    void DestroyText(std::string_view textKey);
+    // drops every texture rendered with the font, call before closing it
+    void DestroyFontTexts(TTF_Font* font);
+    [[nodiscard]] const TextManager_Stats& GetStats() const { return this->stats; }
 };
\ No newline at end of file
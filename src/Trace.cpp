@@ -0,0 +1,114 @@
+#include "Trace.h"
+
+#include <SDL3/SDL_log.h>
+#include <SDL3/SDL_thread.h>
+#include <SDL3/SDL_timer.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+// Each slot is a small seqlock: the sequence is odd while a writer fills it and 2 * (index + 1) once event index
+// is complete, so a reader can tell torn or overwritten slots apart without ever blocking a writer.
+struct Trace_Slot {
+    std::atomic<Uint64> sequence{0};
+    std::atomic<const char *> name{nullptr};
+    std::atomic<Uint64> startNS{0};
+    std::atomic<Uint64> durationNS{0};
+    std::atomic<Uint64> threadID{0};
+};
+
+static std::array<Trace_Slot, TRACE_CAPACITY> slots;
+static std::atomic<Uint64> nextIndex = 0;
+
+void Trace_Record(const char *name, const Uint64 startNS, const Uint64 endNS) {
+    const Uint64 index = nextIndex.fetch_add(1, std::memory_order_relaxed);
+    Trace_Slot &slot = slots[index % TRACE_CAPACITY];
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.startNS.store(startNS, std::memory_order_relaxed);
+    slot.durationNS.store(endNS - startNS, std::memory_order_relaxed);
+    slot.threadID.store(SDL_GetCurrentThreadID(), std::memory_order_relaxed);
+    slot.sequence.store(2 * (index + 1), std::memory_order_release);
+}
+
+void Trace_Snapshot(std::vector<Trace_Event> &events) {
+    events.clear();
+    const Uint64 end = nextIndex.load(std::memory_order_acquire);
+    const Uint64 begin = end > TRACE_CAPACITY ? end - TRACE_CAPACITY : 0;
+    for (Uint64 index = begin; index < end; ++index) {
+        const Trace_Slot &slot = slots[index % TRACE_CAPACITY];
+        const Uint64 sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence != 2 * (index + 1)) {
+            // still being written, or already reused for a newer event
+            continue;
+        }
+        const Trace_Event event = {slot.name.load(std::memory_order_relaxed),
+                                   slot.startNS.load(std::memory_order_relaxed),
+                                   slot.durationNS.load(std::memory_order_relaxed),
+                                   slot.threadID.load(std::memory_order_relaxed)};
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == sequence) {
+            events.push_back(event);
+        }
+    }
+}
+
+void Trace_Summarize(const Uint64 spanNS, std::vector<Trace_Event> &scratch, std::vector<Trace_Stage> &stages) {
+    Trace_Snapshot(scratch);
+    stages.clear();
+    const Uint64 now = SDL_GetTicksNS();
+    const Uint64 since = now > spanNS ? now - spanNS : 0;
+    for (const Trace_Event &event: scratch) {
+        if (event.startNS < since) {
+            continue;
+        }
+        // only a handful of stages exist, a linear search beats building a map every refresh
+        auto it = std::ranges::find_if(stages, [&event](const Trace_Stage &stage) {
+            return stage.name == event.name || std::strcmp(stage.name, event.name) == 0;
+        });
+        if (it == stages.end()) {
+            it = stages.insert(stages.end(), {event.name, 0, 0, 0});
+        }
+        it->count++;
+        it->totalNS += event.durationNS;
+        it->maxNS = std::max(it->maxNS, event.durationNS);
+    }
+}
+
+bool Trace_WriteChromeJson(const std::string &path) {
+    std::vector<Trace_Event> events;
+    Trace_Snapshot(events);
+    nlohmann::json traceEvents = nlohmann::json::array();
+    for (const auto &[name, startNS, durationNS, threadID]: events) {
+        // complete events, timestamps in microseconds
+        traceEvents.push_back({{"name", name},
+                               {"ph", "X"},
+                               {"ts", static_cast<double>(startNS) / 1000.0},
+                               {"dur", static_cast<double>(durationNS) / 1000.0},
+                               {"pid", 1},
+                               {"tid", threadID}});
+    }
+    const nlohmann::json trace = {{"traceEvents", traceEvents}, {"displayTimeUnit", "ms"}};
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << trace.dump();
+    if (!file) {
+        SDL_Log("Couldn't write trace to %s", path.c_str());
+        return false;
+    }
+    SDL_Log("Wrote %zu trace events to %s", events.size(), path.c_str());
+    return true;
+}
+
+Trace_Scope::Trace_Scope(const char *name) {
+    this->name = name;
+    this->startNS = SDL_GetTicksNS();
+}
+
+Trace_Scope::~Trace_Scope() {
+    Trace_Record(name, startNS, SDL_GetTicksNS());
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <SDL3/SDL_stdinc.h>
+#include <string>
+#include <vector>
+
+// Slots in the trace ring buffer, the oldest scopes are overwritten once it is full.
+static constexpr size_t TRACE_CAPACITY = 8192;
+
+struct Trace_Event {
+    // a string literal, events only store the pointer
+    const char* name;
+    Uint64 startNS;
+    Uint64 durationNS;
+    Uint64 threadID;
+};
+
+// Per-stage numbers over a span of recent events, for the settings window HUD.
+struct Trace_Stage {
+    const char* name;
+    Uint64 count;
+    Uint64 totalNS;
+    Uint64 maxNS;
+};
+
+// Records a finished scope. Safe to call from any thread, it never blocks or allocates.
+void Trace_Record(const char* name, Uint64 startNS, Uint64 endNS);
+// copies the events that are still in the buffer, oldest first
+void Trace_Snapshot(std::vector<Trace_Event>& events);
+// sums up the events that started within the last spanNS, stages stay in the order they first appear
+void Trace_Summarize(Uint64 spanNS, std::vector<Trace_Event>& scratch, std::vector<Trace_Stage>& stages);
+// writes the buffer as Chrome trace event JSON, which chrome://tracing and Perfetto open directly
+bool Trace_WriteChromeJson(const std::string& path);
+
+// Times the enclosing scope. The name can still be changed before the scope ends, e.g. once a cache lookup
+// knows whether it hit.
+class Trace_Scope {
+    const char* name;
+    Uint64 startNS;
+public:
+    explicit Trace_Scope(const char* name);
+    ~Trace_Scope();
+    Trace_Scope(const Trace_Scope&) = delete;
+    Trace_Scope& operator=(const Trace_Scope&) = delete;
+    void SetName(const char* name) { this->name = name; }
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) const Trace_Scope TRACE_CONCAT(traceScope, __LINE__)(name)
@@ -1,30 +1,48 @@
 #define SDL_MAIN_USE_CALLBACKS 1
 #define USE_TASKBAR_LEFT_POSITION false
 #define SETTINGS_FILE_PATH "./settings.json"
+#define SCHEDULE_CACHE_FILE_PATH "./schedule_cache.dat"
+// every fetched schedule is kept in <path>.dat and <path>.idx
+#define SCHEDULE_HISTORY_PATH "./schedule_history"
+// can be overridden at build time, e.g. to point the overlay at a local mock server
+#ifndef SCHEDULE_JSON_URL
 #define SCHEDULE_JSON_URL "https://api.croomssched.tech/today"
-#define FETCH_TRIES 50
-#define USE_LARGE_TEXT false
-
-#if USE_LARGE_TEXT == true
-#define BELL_FONT_SIZE 0.75f
-#else
-#define BELL_FONT_SIZE 0.43f
 #endif
-
+#define FETCH_RETRY_BASE_DELAY_MS 2000
+#define FETCH_RETRY_MAX_DELAY_MS (15 * 60 * 1000)
+// the next day's schedule is fetched at a random moment within this many seconds after midnight
+#define REFRESH_WINDOW_SECONDS (10 * 60)
+// --simulate FILE [--start HH:MM] [--speed N] replays a saved response from the given time N times faster
+#define SIMULATION_DEFAULT_SPEED 60.0
+// pressing F12 in the settings window writes the recent trace scopes here, open it in chrome://tracing or Perfetto
+#define TRACE_FILE_PATH "./trace.json"
 #include <SDL3/SDL.h>
 #include <SDL3/SDL_main.h>
 #include <SDL3_ttf/SDL_ttf.h>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <cpr/cpr.h>
-#include <nlohmann/json.hpp>
+#include <memory>
 #include <string>
 
+#include "AllocationCounter.h"
+#include "ClockSource.h"
+#include "FontCache.h"
+#include "FrameScheduler.h"
+#include "Overlay.h"
+#include "RefreshPlanner.h"
 #include "Schedule.h"
+#include "ScheduleCache.h"
+#include "ScheduleClock.h"
+#include "ScheduleFetcher.h"
+#include "ScheduleHistory.h"
+#include "ScheduleParser.h"
 #include "Settings.h"
+#include "SettingsWatcher.h"
 #include "TextManager.h"
-
-using json = nlohmann::json;
-
-static const auto GMT_OFFSET = std::chrono::hours(-5);
+#include "Trace.h"
 
 static SDL_Window *window = nullptr;
 static SDL_Renderer *renderer = nullptr;
@@ -38,14 +56,27 @@ static int currentWinX;
 static int currentWinY;
 static int currentWinWidth;
 static int currentWinHeight;
-static int fetchTry = 0;
-static int elipsesCount = 0;
-static int elipsesTimer = 0;
-static bool isFetching = false;
+// set by display and window events, the layout and scale are only recomputed after one of them
+static bool geometryDirty = true;
 static Settings *settings;
-static TTF_Font *currentFont;
-static Schedule *schedule = nullptr;
+static SettingsWatcher *settingsWatcher = nullptr;
+// pushed by the watcher thread whenever the settings file changed on disk
+static Uint32 settingsChangedEventType = 0;
+// shared by the overlay and the settings window, keyed by pixel size for the font file in use
+static FontCache *fontCache = nullptr;
+// published by the fetch thread, the render loop only ever loads a snapshot of it
+static std::atomic<std::shared_ptr<const Schedule>> schedule;
+static ClockSource *clockSource = nullptr;
+static bool isSimulation = false;
+// replaced when the time zone setting changes, the fetch thread keeps whichever one it loaded
+static std::atomic<std::shared_ptr<ScheduleClock>> scheduleClock;
+static ScheduleCache *scheduleCache = nullptr;
+static ScheduleHistory *scheduleHistory = nullptr;
+static ScheduleFetcher *scheduleFetcher = nullptr;
+static RefreshPlanner *refreshPlanner = nullptr;
 static TextManager *textManager = nullptr;
+static FrameScheduler *frameScheduler = nullptr;
+static Overlay *overlay = nullptr;
 
 
 void CalculateWindowPosAndSize(SDL_Window *window) {
@@ -61,40 +92,122 @@ void CalculateWindowPosAndSize(SDL_Window *window) {
     windowY = static_cast<int>(std::round(static_cast<float>(displayMode->h) - static_cast<float>(windowHeight)));
 }
 
-void FetchSchedule0() {
-    if (fetchTry > FETCH_TRIES) {
-        SDL_Log("Failed to fetch schedule! Exceeded %d tries, exiting!", FETCH_TRIES);
-        exit(1);
-    }
-    auto r = GetCallback([](const cpr::Response& res) {
-        if (res.status_code != 200) {
-            SDL_Log("Failed to fetch schedule! Error: Server returned %s", std::to_string(res.status_code).c_str());
-            return FetchSchedule0();
+// moves the overlay back into place if the display or the window changed since the last check
+void UpdateWindowGeometry() {
+    TRACE_SCOPE("Window geometry");
+    scale = SDL_GetWindowDisplayScale(window);
+    CalculateWindowPosAndSize(window);
+    if (SDL_GetWindowPosition(window, &currentWinX, &currentWinY)) {
+        if (currentWinX != windowX || currentWinY != windowY) {
+            SDL_SetWindowPosition(window, windowX, windowY);
+            SDL_Log("Window moved back to correct position");
         }
-        const auto jsonSchedule = json::parse(res.text);
-        schedule = new Schedule(jsonSchedule, settings);
-        if (schedule->GetStatus() != "OK" && schedule != nullptr) {
-            SDL_Log("Failed to fetch schedule! Error: Expected \"OK\" in JSON file status property, but got %s instead.",
-                    schedule->GetStatus().c_str());
-            delete schedule;
-            schedule = nullptr;
-            return FetchSchedule0();
+    }
+    if (SDL_GetWindowSize(window, &currentWinWidth, &currentWinHeight)) {
+        if (currentWinWidth != windowWidth || currentWinHeight != windowHeight) {
+            SDL_SetWindowSize(window, windowWidth, windowHeight);
+            SDL_Log("Window scaled to correct scale");
         }
-        isFetching = false;
-    }, cpr::Url{SCHEDULE_JSON_URL});
-    fetchTry++;
+    }
+}
+
+long long GetCurrentDay() {
+    // also called from the fetch thread, so this goes through the uncached lookup
+    return scheduleClock.load()->DayOf(clockSource->Now());
 }
 
-void FetchSchedule() {
-    if (!isFetching) {
-        isFetching = true;
-        FetchSchedule0();
+bool OnScheduleResponse(const std::string &body) {
+    Schedule_Response response;
+    if (Sched_ParseError error; !Sched_ParseResponse(body, response, error)) {
+        SDL_Log("Failed to fetch schedule! Error: Invalid response (%s)", error.message.c_str());
+        return false;
+    }
+    if (response.status != "OK") {
+        SDL_Log("Failed to fetch schedule! Error: Expected \"OK\" in JSON file status property, but got %s instead.",
+                response.status.c_str());
+        return false;
+    }
+    const long long day = GetCurrentDay();
+    // simulated days would overwrite the real cache and history
+    if (!isSimulation) {
+        scheduleCache->Store(day, body);
+        scheduleHistory->Append(day, response.data);
     }
+    schedule.store(
+            std::make_shared<const Schedule>(std::move(response.status), std::move(response.data), day, settings));
+    frameScheduler->RequestWakeup();
+    return true;
 }
 
+void ScheduleRefreshCheck() {
+    // wake up when the planned refresh after the next midnight is due
+    const auto untilRefresh = refreshPlanner->TimeUntilRefresh(clockSource->Now());
+    frameScheduler->ScheduleIn(clockSource->ToRealDuration(untilRefresh).count());
+}
+
+void OnSettingsFileChanged() {
+    const unsigned changes = settings->Reload();
+    if (changes == SETTINGS_CHANGE_NONE) {
+        return;
+    }
+    SDL_Log("Applied changes from %s", SETTINGS_FILE_PATH);
+    if (changes & SETTINGS_CHANGE_FONT) {
+        // the new font is opened at every size on the next frame
+        settings->ApplyFontLocation();
+    }
+    if (changes & SETTINGS_CHANGE_TIME_ZONE) {
+        // the planner points at the clock, so it is replaced first and re-plans the refresh in the new zone
+        auto newClock = std::make_shared<ScheduleClock>(settings->timeZone, clockSource);
+        delete refreshPlanner;
+        refreshPlanner = new RefreshPlanner(newClock.get(), std::chrono::seconds(REFRESH_WINDOW_SECONDS));
+        scheduleClock.store(std::move(newClock));
+        geometryDirty = true;
+        SDL_Log("Switched to time zone %s", settings->timeZone.c_str());
+    }
+    // aliases, colors and the lunch track are read every frame, a redraw is all they need
+    frameScheduler->Invalidate();
+}
+
+void CreateClockSource(const int argc, char *argv[], std::string &scheduleUrl) {
+    std::string simulationFile;
+    int startHours = -1;
+    int startMinutes = 0;
+    double speed = SIMULATION_DEFAULT_SPEED;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--simulate") == 0) {
+            simulationFile = argv[i + 1];
+        } else if (std::strcmp(argv[i], "--start") == 0) {
+            if (std::sscanf(argv[i + 1], "%d:%d", &startHours, &startMinutes) != 2) {
+                startHours = -1;
+            }
+        } else if (std::strcmp(argv[i], "--speed") == 0) {
+            speed = std::atof(argv[i + 1]);
+        }
+    }
+    if (simulationFile.empty()) {
+        clockSource = new SystemClockSource();
+        return;
+    }
+
+    // the simulation starts today at the given local time, or right now
+    const SystemClockSource systemClock;
+    const ScheduleClock realClock(settings->timeZone, &systemClock);
+    auto start = systemClock.Now();
+    if (startHours >= 0) {
+        start = realClock.MidnightOf(realClock.DayOf(start)) + std::chrono::hours(startHours) +
+                std::chrono::minutes(startMinutes);
+    }
+    clockSource = new SimulatedClockSource(start, speed);
+    isSimulation = true;
+    scheduleUrl = "file://" + simulationFile;
+    SDL_Log("Simulating %s at %gx speed", simulationFile.c_str(), speed > 0 ? speed : 1.0);
+}
 
 SDL_AppResult SDL_AppInit(void **appstate, int argc, char *argv[]) {
     settings = new Settings(SETTINGS_FILE_PATH);
+    std::string scheduleUrl = SCHEDULE_JSON_URL;
+    CreateClockSource(argc, argv, scheduleUrl);
+    scheduleClock.store(std::make_shared<ScheduleClock>(settings->timeZone, clockSource));
 
     if (!SDL_Init(SDL_INIT_VIDEO)) {
         SDL_Log("Couldn't initialize SDL: %s", SDL_GetError());
@@ -117,13 +230,21 @@ SDL_AppResult SDL_AppInit(void **appstate, int argc, char *argv[]) {
         return SDL_APP_FAILURE;
     }
 
-    currentFont = TTF_OpenFont(settings->fontLocation.c_str(), 32);
-    if (currentFont == nullptr) {
-        SDL_Log("TTF_OpenFont() Error: %s", SDL_GetError());
+    fontCache = new FontCache(settings->fontLocation);
+    // makes sure the font file opens before anything else is set up
+    if (fontCache->Acquire(32) == nullptr) {
         return SDL_APP_FAILURE;
     }
+    fontCache->Release(32);
+    fontCache->SetOnClose([](TTF_Font *font) {
+        textManager->DestroyFontTexts(font);
+        settings->OnFontClosed(font);
+    });
+    settings->SetFontCache(fontCache);
 
     textManager = new TextManager(renderer);
+    frameScheduler = new FrameScheduler(window, clockSource);
+    overlay = new Overlay(renderer, textManager, settings, fontCache);
 
     scale = SDL_GetWindowDisplayScale(window);
     CalculateWindowPosAndSize(window);
@@ -135,7 +256,38 @@ SDL_AppResult SDL_AppInit(void **appstate, int argc, char *argv[]) {
         SDL_RaiseWindow(window);
     }
 
-    FetchSchedule();
+    // show today's cached schedule right away, the fetch below refreshes it in the background
+    scheduleCache = new ScheduleCache(SCHEDULE_CACHE_FILE_PATH);
+    scheduleHistory = new ScheduleHistory(SCHEDULE_HISTORY_PATH);
+    refreshPlanner = new RefreshPlanner(scheduleClock.load().get(), std::chrono::seconds(REFRESH_WINDOW_SECONDS));
+    if (std::string cachedSchedule; !isSimulation && scheduleCache->Load(GetCurrentDay(), cachedSchedule)) {
+        Schedule_Response response;
+        if (Sched_ParseError error; Sched_ParseResponse(cachedSchedule, response, error)) {
+            schedule.store(std::make_shared<const Schedule>(std::move(response.status), std::move(response.data),
+                                                            GetCurrentDay(), settings));
+            SDL_Log("Loaded today's schedule from %s", SCHEDULE_CACHE_FILE_PATH);
+        } else {
+            SDL_Log("Ignoring invalid schedule cache %s (%s)", SCHEDULE_CACHE_FILE_PATH, error.message.c_str());
+        }
+    }
+    // the history keeps every day we've fetched, so it still has today if the cache file is gone or corrupt
+    if (Schedule_Data data;
+        !isSimulation && schedule.load() == nullptr && scheduleHistory->Lookup(GetCurrentDay(), data)) {
+        schedule.store(std::make_shared<const Schedule>("OK", std::move(data), GetCurrentDay(), settings));
+        SDL_Log("Loaded today's schedule from %s", SCHEDULE_HISTORY_PATH);
+    }
+
+    scheduleFetcher = new ScheduleFetcher(scheduleUrl, OnScheduleResponse,
+                                          {.baseDelay = std::chrono::milliseconds(FETCH_RETRY_BASE_DELAY_MS),
+                                           .maxDelay = std::chrono::milliseconds(FETCH_RETRY_MAX_DELAY_MS)});
+    scheduleFetcher->Fetch();
+
+    settingsChangedEventType = SDL_RegisterEvents(1);
+    settingsWatcher = new SettingsWatcher(SETTINGS_FILE_PATH, [] {
+        SDL_Event event = {};
+        event.type = settingsChangedEventType;
+        SDL_PushEvent(&event);
+    });
 
     SDL_Log("Successfully loaded!");
 
@@ -147,8 +299,29 @@ SDL_AppResult SDL_AppEvent(void *appstate, SDL_Event *event) {
     if (settings != nullptr) {
         if (settings->isSettingsOpen()) {
             settings->PollEvent(event);
+            // changes made in the settings window show up on the overlay right away
+            if (event->type == SDL_EVENT_MOUSE_BUTTON_DOWN || event->type == SDL_EVENT_KEY_DOWN ||
+                event->type == SDL_EVENT_TEXT_INPUT) {
+                frameScheduler->Invalidate();
+            }
+            if (event->type == SDL_EVENT_KEY_DOWN && event->key.key == SDLK_F12) {
+                Trace_WriteChromeJson(TRACE_FILE_PATH);
+            }
         }
     }
+    if (settingsChangedEventType != 0 && event->type == settingsChangedEventType) {
+        OnSettingsFileChanged();
+        return SDL_APP_CONTINUE;
+    }
+    if (frameScheduler->IsWakeEvent(event)) {
+        frameScheduler->Invalidate();
+        return SDL_APP_CONTINUE;
+    }
+    if (event->type >= SDL_EVENT_DISPLAY_FIRST && event->type <= SDL_EVENT_DISPLAY_LAST) {
+        geometryDirty = true;
+        frameScheduler->Invalidate();
+        return SDL_APP_CONTINUE;
+    }
     if (event->window.windowID == windowID) {
         switch (event->type) {
             case SDL_EVENT_MOUSE_BUTTON_DOWN:
@@ -156,6 +329,22 @@ SDL_AppResult SDL_AppEvent(void *appstate, SDL_Event *event) {
                     settings->OpenSettings();
                     settings->RaiseWindow();
                 }
+                frameScheduler->Invalidate();
+            return SDL_APP_CONTINUE;
+            case SDL_EVENT_WINDOW_MOVED:
+            case SDL_EVENT_WINDOW_RESIZED:
+            case SDL_EVENT_WINDOW_DISPLAY_CHANGED:
+            case SDL_EVENT_WINDOW_DISPLAY_SCALE_CHANGED:
+                geometryDirty = true;
+                frameScheduler->OnWindowEvent(event);
+            return SDL_APP_CONTINUE;
+            case SDL_EVENT_WINDOW_SHOWN:
+            case SDL_EVENT_WINDOW_HIDDEN:
+            case SDL_EVENT_WINDOW_EXPOSED:
+            case SDL_EVENT_WINDOW_MINIMIZED:
+            case SDL_EVENT_WINDOW_RESTORED:
+            case SDL_EVENT_WINDOW_OCCLUDED:
+                frameScheduler->OnWindowEvent(event);
             return SDL_APP_CONTINUE;
             case SDL_EVENT_QUIT:
             case SDL_EVENT_TERMINATING:
@@ -168,6 +357,25 @@ SDL_AppResult SDL_AppEvent(void *appstate, SDL_Event *event) {
 
 
 SDL_AppResult SDL_AppIterate(void *appstate) {
+    const bool settingsOpen = settings != nullptr && settings->isSettingsOpen();
+    if (settingsOpen) {
+        settings->SettingsIterate();
+    }
+    settings->SaveIfDue();
+    if (!frameScheduler->IsFrameDue()) {
+        // edited aliases are only rebuilt with the save, the frame at its deadline shows them
+        if (const Uint64 saveAtNS = settings->GetSaveDeadlineNS(); saveAtNS != 0) {
+            const Uint64 now = SDL_GetTicksNS();
+            frameScheduler->ScheduleIn(saveAtNS > now ? saveAtNS - now : 0);
+        }
+        // the settings window only redraws after its own events, so both windows can wait for the next one
+        if (settingsOpen && settings->IsTraceHudShown()) {
+            frameScheduler->ScheduleIn(TRACE_HUD_REFRESH_NS);
+        }
+        frameScheduler->WaitForNextFrame();
+        return SDL_APP_CONTINUE;
+    }
+
     if (std::string(SDL_GetPlatform()) == "Windows") {
         if (settings != nullptr) {
             if (!settings->SettingsWindowHasFocus()){
@@ -178,145 +386,82 @@ SDL_AppResult SDL_AppIterate(void *appstate) {
         }
     }
 
-    SDL_Color fontColor;
-    switch (settings->theme) {
-        case LIGHT:
-            fontColor = {0, 0, 0, 255};
-            break;
-        case DARK:
-        default:
-            fontColor = {255, 255, 255, 255};
-            break;
-    }
-
-    if (schedule != nullptr && !isFetching) {
-        const auto resTime = std::chrono::duration_cast<std::chrono::days>(schedule->GetResponseTime());
-        // give the server 5 seconds to make sure it returns the correct schedule
-        if (const auto now =
-                    std::chrono::duration_cast<std::chrono::days>(
-                    std::chrono::system_clock::now().time_since_epoch() + GMT_OFFSET - std::chrono::seconds(5) );
-            now > resTime) {
-            SDL_Log("Current Schedule is outdated. Fetching new schedule!");
-            delete schedule;
-            schedule = nullptr;
-            FetchSchedule();
-        }
+    // the snapshot stays alive for the whole frame even if the fetch thread publishes a new one meanwhile
+    std::shared_ptr<const Schedule> currentSchedule = schedule.load();
+    if (currentSchedule != nullptr) {
+        // the timelines of every track are built with the schedule, switching tracks only changes the index
+        settings->SetTrackCount(currentSchedule->GetTrackCount());
     }
 
-    scale = SDL_GetWindowDisplayScale(window);
-    CalculateWindowPosAndSize(window);
-    SDL_SetWindowSize(window, windowWidth, windowHeight);
-    if (SDL_GetWindowPosition(window, &currentWinX, &currentWinY)) {
-        if (currentWinX != windowX || currentWinY != windowY) {
-            SDL_SetWindowPosition(window, windowX, windowY);
-            SDL_Log("Window moved back to correct position");
-        }
-    }
-    if (SDL_GetWindowSize(window, &currentWinWidth, &currentWinHeight)) {
-        if (currentWinWidth != windowWidth || currentWinHeight != windowHeight) {
-            SDL_SetWindowSize(window, windowWidth, windowHeight);
-            SDL_Log("Window scaled to correct scale");
+    const bool canRefresh = currentSchedule != nullptr && !scheduleFetcher->IsFetching();
+    if (canRefresh) {
+        refreshPlanner->Plan(currentSchedule->GetDay());
+        if (refreshPlanner->IsRefreshDue(clockSource->Now())) {
+            SDL_Log("Current Schedule is outdated. Fetching new schedule!");
+            const TextManager_Stats &textStats = textManager->GetStats();
+            SDL_Log("Text cache: %llu hits, %llu misses, %llu evictions, %zu textures using %zu bytes, "
+                    "%zu atlases using %zu bytes",
+                    static_cast<unsigned long long>(textStats.hits), static_cast<unsigned long long>(textStats.misses),
+                    static_cast<unsigned long long>(textStats.evictions), textStats.textureCount,
+                    textStats.textureBytes, textStats.atlasCount, textStats.atlasBytes);
+            // the outdated schedule stays on screen until the new one is published, so there is no blank gap
+            scheduleFetcher->Fetch();
         }
     }
 
-    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
-
-    SDL_RenderClear(renderer);
-
-    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-    // ReSharper disable once CppUseStructuredBinding
-    const SDL_FRect dimensions = textManager->RenderText(currentFont, "dimensionText", "A", INT32_MAX, INT32_MAX, fontColor, 0.43f * scale);
-
-    if (schedule != nullptr && !isFetching) {
-        const int timeLeft = schedule->GetSecondsLeft();
-        const int totalEventTime = schedule->GetEventSeconds();
-        const std::string scheduleEventName = schedule->GetCurrentEvent();
-
-        float percentage = ((static_cast<float>(totalEventTime) - static_cast<float>(timeLeft)) / static_cast<float>(totalEventTime)) * 100;
-        const std::string dayType = schedule->GetData().msg;
-        // TODO: add setting to hide percentage
-        std::string event = scheduleEventName + ", Time Left: ";
-        if (settings->showPercentage) {
-            event = std::format("{:.2f}", percentage) + "% - " + event;
-        }
-        const int hoursLeft = timeLeft / 60 / 60;
-        const int minLeft = (timeLeft - hoursLeft * 60 * 60) / 60;
-        const int secsLeft = timeLeft - minLeft * 60 - hoursLeft * 60 * 60;
-        const SDL_Color schedColor = schedule->CalculateTextColor(timeLeft);
-
-#if USE_LARGE_TEXT == true
-        const SDL_FRect eventName = {5, 0, 0, 0};
-        const SDL_FRect dayTypeText = {};
-#else
-        // ReSharper disable once CppUseStructuredBinding
-        const SDL_FRect dayTypeText = textManager->RenderText(currentFont, "display.dayType", dayType, 10, static_cast<float>(windowHeight) - 6 - dimensions.h * 2, schedColor, 0.43f * scale);
-
-        // ReSharper disable once CppUseStructuredBinding
-
-        const SDL_FRect eventName =
-                textManager->RenderText(currentFont, "display.classTimeLeft.eventName",
-                    event, 10, static_cast<float>(windowHeight) - 7 - dayTypeText.h, schedColor, 0.43f * scale);
-#endif
-
-
-        std::string hrsMins;
-
-        if (hoursLeft != 0) {
-            hrsMins = Schedule::PadTime(hoursLeft, 2) + ":" + Schedule::PadTime(minLeft, 2);
-        } else {
-            hrsMins = Schedule::PadTime(minLeft, 2);
+    if (!frameScheduler->IsVisible()) {
+        if (canRefresh && !scheduleFetcher->IsFetching()) {
+            ScheduleRefreshCheck();
         }
+        return SDL_APP_CONTINUE;
+    }
 
-        // ReSharper disable once CppUseStructuredBinding
-        const SDL_FRect hrsMinsDimensions =
-                textManager->RenderText(currentFont, "display.classTimeLeft.HrsMins", hrsMins, eventName.x + eventName.w,
-                                        eventName.y, schedColor, BELL_FONT_SIZE * scale);
+    // our own corrections fire moved and resized events too, the check after them finds nothing to do
+    if (geometryDirty) {
+        geometryDirty = false;
+        UpdateWindowGeometry();
+    }
 
-        const char *secs = (":" + Schedule::PadTime(secsLeft, 2)).c_str();
-        if (settings->showSeconds) {
-            textManager->RenderText(currentFont, "display.classTimeLeft.Seconds", secs,
-                                    hrsMinsDimensions.x + hrsMinsDimensions.w, hrsMinsDimensions.y, {schedColor.r, schedColor.g, schedColor.b, 100}, BELL_FONT_SIZE * scale);
+    const Uint64 allocationsBefore = Alloc_GetCount();
+    // one clock read per frame so the name, countdown and progress always agree
+    const std::shared_ptr<ScheduleClock> clock = scheduleClock.load();
+    const Overlay_Frame frame = overlay->Render(currentSchedule.get(), clock->GetSecondsOfDay(), scale,
+                                                windowWidth, windowHeight);
+    if constexpr (ALLOC_COUNTING) {
+        // only frames that created new text should show up here
+        if (const Uint64 allocations = Alloc_GetCount() - allocationsBefore; allocations > 0) {
+            SDL_Log("Frame made %llu heap allocations", static_cast<unsigned long long>(allocations));
         }
-        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
-        if (settings->showProgressBar) {
-            // ReSharper disable once CppUseStructuredBinding
-            const SDL_Color progressBarColor = schedule->CalculateProgressBarColor(timeLeft);
-            SDL_SetRenderDrawColor(renderer, progressBarColor.r, progressBarColor.g, progressBarColor.b, 100);
-            const auto progressBarBG = SDL_FRect{0, static_cast<float>(windowHeight) - scale * 2, static_cast<float>(windowWidth), scale * 2};
-            SDL_RenderFillRect(renderer, &progressBarBG);
-            SDL_SetRenderDrawColor(renderer, progressBarColor.r, progressBarColor.g, progressBarColor.b, progressBarColor.a);
-            const auto progressBar = SDL_FRect{0, static_cast<float>(windowHeight) - scale * 2,
-                static_cast<float>(windowWidth) * (static_cast<float>(totalEventTime - timeLeft) / static_cast<float>(totalEventTime)), scale * 2 + 10};
-            SDL_RenderFillRect(renderer, &progressBar);
+    }
+    if (frame.hasSchedule) {
+        // anything that changes every second needs a frame per second, otherwise only the minutes change
+        frameScheduler->ScheduleNextVisibleChange(*clock, frame.changesEverySecond);
+        if (canRefresh && !scheduleFetcher->IsFetching()) {
+            ScheduleRefreshCheck();
         }
     } else {
-        std::string loadingText = "Fetching Schedule";
-        for (int i = 0; i < elipsesCount; ++i) {
-            loadingText += ".";
-        }
-        textManager->RenderText(currentFont, "display.loading", loadingText,
-            10, static_cast<float>(windowHeight) - 7 - dimensions.h, fontColor, 0.43f * scale);
-        elipsesTimer += 200;
-        if (elipsesTimer > 400) {
-            elipsesCount++;
-            elipsesTimer = 0;
-        }
-        if (elipsesCount > 3) {
-            elipsesCount = 0;
-        }
+        // loading animation
+        frameScheduler->ScheduleIn(SDL_MS_TO_NS(200));
     }
 
-    SDL_RenderPresent(renderer);
-
-    if (settings != nullptr) {
-        if (settings->isSettingsOpen()) {
-            settings->SettingsIterate();
-            return SDL_APP_CONTINUE;
-        }
-    }
-    SDL_Delay(200);
     return SDL_APP_CONTINUE;
 }
 
 
-void SDL_AppQuit(void *appstate, SDL_AppResult result) { TTF_Quit(); }
+void SDL_AppQuit(void *appstate, SDL_AppResult result) {
+    // stops retrying and aborts a request that is still in flight
+    delete scheduleFetcher;
+    scheduleFetcher = nullptr;
+    delete scheduleHistory;
+    scheduleHistory = nullptr;
+    delete settingsWatcher;
+    settingsWatcher = nullptr;
+    // makes sure the last settings change is on disk before exiting
+    if (settings != nullptr) {
+        settings->CloseSettings();
+        settings->Flush();
+    }
+    delete fontCache;
+    fontCache = nullptr;
+    TTF_Quit();
+}